@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "custom_vector.h"
+
+/** A vector of records stored as an array of structs of arrays. Records are grouped into blocks of Lanes and each
+    block holds one array per field, so a kernel over one field reads a dense, aligned array of Lanes values which
+    maps onto SIMD registers, while all fields of a record still sit in the same block rather than in separate buffers.
+
+    Records are added as one value per field. Blocks are allocated whole, so unused lanes of the last block hold value
+    initialized fields. Scalar access returns a tuple of references to the fields of one record. */
+template <size_t Lanes, typename... Fields>
+class aosoa_vector
+{
+    static_assert(Lanes > 0, "Blocks need at least one lane");
+    static_assert(sizeof...(Fields) > 0, "Records need at least one field");
+
+    /** The lanes of one field within a block, aligned to their size up to a cache line so SIMD loads are aligned */
+    template <typename F>
+    struct alignas(std::max(alignof(F), std::bit_floor(std::min<size_t>(sizeof(F) * Lanes, 64)))) lane_array
+    {
+        F values[Lanes];
+    };
+
+    using block = std::tuple<lane_array<Fields>...>;
+
+    template <size_t I>
+    using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+public:
+    /** Tuple of references to the fields of one record */
+    using reference = std::tuple<Fields&...>;
+
+    /** Tuple of constant references to the fields of one record */
+    using const_reference = std::tuple<const Fields&...>;
+
+    /** Amount of records in every block */
+    static constexpr size_t lanes = Lanes;
+
+    /** Default constructor */
+    aosoa_vector() : size_(0) {}
+
+    /** Adds a record to the end of the vector, allocating a new block as needed
+        @param[in] fields Value of each field of the record */
+    void push_back(const Fields&... fields)
+    {
+        if (size_ % Lanes == 0)
+        {
+            blocks_.emplace_back();
+        }
+        (*this)[size_] = std::tie(fields...);
+        ++size_;
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return References to the fields of the record at the index given */
+    reference operator[] (size_t index) noexcept
+    {
+        return record(index, std::index_sequence_for<Fields...>{});
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return Constant references to the fields of the record at the index given */
+    const_reference operator[] (size_t index) const noexcept
+    {
+        return record(index, std::index_sequence_for<Fields...>{});
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return One field of the record at the index given */
+    template <size_t I>
+    field_t<I>& get(size_t index) noexcept
+    {
+        return std::get<I>(blocks_[index / Lanes]).values[index % Lanes];
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return One constant field of the record at the index given */
+    template <size_t I>
+    const field_t<I>& get(size_t index) const noexcept
+    {
+        return std::get<I>(blocks_[index / Lanes]).values[index % Lanes];
+    }
+
+    /** See return
+        @param[in] b Index of the block
+        @return The aligned lanes of one field within a block */
+    template <size_t I>
+    std::span<field_t<I>, Lanes> lanes_of(size_t b) noexcept
+    {
+        return std::span<field_t<I>, Lanes>(std::get<I>(blocks_[b]).values);
+    }
+
+    /** See return
+        @param[in] b Index of the block
+        @return The constant aligned lanes of one field within a block */
+    template <size_t I>
+    std::span<const field_t<I>, Lanes> lanes_of(size_t b) const noexcept
+    {
+        return std::span<const field_t<I>, Lanes>(std::get<I>(blocks_[b]).values);
+    }
+
+    /** See return
+        @param[in] b Index of the block
+        @return Amount of lanes of the block which hold records. Lanes for every block but the last. */
+    size_t records_in_block(size_t b) const noexcept
+    {
+        return std::min(Lanes, size_ - b * Lanes);
+    }
+
+    /** Increases capacity to hold at least count records
+        @param[in] count Amount of records the vector should have room for */
+    void reserve(size_t count)
+    {
+        blocks_.reserve((count + Lanes - 1) / Lanes);
+    }
+
+    /** Destructs all records and deallocates memory */
+    void clear() noexcept
+    {
+        blocks_.clear();
+        size_ = 0;
+    }
+
+    /** See return
+        @return Amount of records stored */
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 record stored */
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /** See return
+        @return Amount of blocks allocated, the last of which may be partly used */
+    size_t block_count() const noexcept
+    {
+        return blocks_.size();
+    }
+
+private:
+    custom_vector<block> blocks_;
+    size_t size_;
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return References to every field of the record at the index given */
+    template <size_t... I>
+    reference record(size_t index, std::index_sequence<I...>) noexcept
+    {
+        return reference(get<I>(index)...);
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return Constant references to every field of the record at the index given */
+    template <size_t... I>
+    const_reference record(size_t index, std::index_sequence<I...>) const noexcept
+    {
+        return const_reference(get<I>(index)...);
+    }
+};
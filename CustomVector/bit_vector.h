@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+#include "custom_vector.h"
+
+/** A vector of bools packed 64 to a word, so it takes an eighth of the memory of one byte per flag.
+    Bulk operations work a whole word at a time in plain loops over the words, which compilers vectorize.
+    Bits past the end of the vector in the last word are always 0, so whole words can be counted and combined as is.
+
+    An optional rank index answers rank() in constant time and speeds up select(). It costs 64 bits for every
+    512 bits stored and must be rebuilt with build_rank_index() after changes. Member functions which change the
+    vector drop the index, but writes through the proxies returned by operator[] can't, so rebuild it after those. */
+class bit_vector
+{
+    static constexpr size_t word_bits = 64;
+    static constexpr size_t words_per_block = 8;
+
+public:
+    /** Proxy for a single bit, returned by the non-constant indexing operator */
+    class reference
+    {
+    public:
+        /** Constructor
+            @param[in] word Word holding the bit
+            @param[in] mask Mask selecting the bit within the word */
+        reference(uint64_t& word, uint64_t mask) noexcept : word_(word), mask_(mask) {}
+
+        /** See return
+            @return The value of the bit */
+        operator bool() const noexcept
+        {
+            return (word_ & mask_) != 0;
+        }
+
+        /** Sets the bit
+            @param[in] value New value of the bit
+            @return This proxy */
+        reference& operator=(bool value) noexcept
+        {
+            word_ = value ? (word_ | mask_) : (word_ & ~mask_);
+            return *this;
+        }
+
+        /** Sets the bit to the value of another bit
+            @param[in] a Proxy for the bit to copy
+            @return This proxy */
+        reference& operator=(const reference& a) noexcept
+        {
+            return *this = bool(a);
+        }
+
+        /** Inverts the bit */
+        void flip() noexcept
+        {
+            word_ ^= mask_;
+        }
+
+    private:
+        uint64_t& word_;
+        uint64_t mask_;
+    };
+
+    /** Default constructor */
+    bit_vector() : size_(0) {}
+
+    /** Constructor which creates count bits
+        @param[in] count Amount of bits
+        @param[in] value Value of every bit */
+    explicit bit_vector(size_t count, bool value = false) : size_(0)
+    {
+        resize(count, value);
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return Proxy for the bit at the index given */
+    reference operator[] (size_t index) noexcept
+    {
+        return reference(words_[index / word_bits], bit(index));
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The bit at the index given */
+    bool operator[] (size_t index) const noexcept
+    {
+        return (words_[index / word_bits] & bit(index)) != 0;
+    }
+
+    /** Adds a bit to the end of the vector, allocating memory as needed.
+        @param[in] value Value of the new bit */
+    void push_back(bool value)
+    {
+        if (size_ % word_bits == 0)
+        {
+            words_.push_back(0);
+        }
+        words_[size_ / word_bits] |= uint64_t(value) << (size_ % word_bits);
+        ++size_;
+        drop_rank_index();
+    }
+
+    /** Changes the amount of bits stored
+        @param[in] count New amount of bits
+        @param[in] value Value of any bits added */
+    void resize(size_t count, bool value = false)
+    {
+        words_.resize(words_for(count), 0);
+        if (count > size_)
+        {
+            fill(size_, count, value);
+        }
+        size_ = count;
+        clear_unused_bits();
+        drop_rank_index();
+    }
+
+    /** Increases capacity to hold at least count bits
+        @param[in] count Amount of bits the vector should have room for */
+    void reserve(size_t count)
+    {
+        words_.reserve(words_for(count));
+    }
+
+    /** Removes every bit and deallocates memory */
+    void clear() noexcept
+    {
+        words_.clear();
+        ranks_.clear();
+        size_ = 0;
+    }
+
+    /** Sets every bit in the half open range [first, last) a word at a time
+        @param[in] first Index of the first bit
+        @param[in] last Index 1 past the last bit */
+    void set(size_t first, size_t last) noexcept
+    {
+        fill(first, last, true);
+        drop_rank_index();
+    }
+
+    /** Clears every bit in the half open range [first, last) a word at a time
+        @param[in] first Index of the first bit
+        @param[in] last Index 1 past the last bit */
+    void reset(size_t first, size_t last) noexcept
+    {
+        fill(first, last, false);
+        drop_rank_index();
+    }
+
+    /** Inverts every bit */
+    void flip() noexcept
+    {
+        for (auto& word : words_)
+        {
+            word = ~word;
+        }
+        clear_unused_bits();
+        drop_rank_index();
+    }
+
+    /** See return
+        @return Amount of set bits */
+    size_t count() const noexcept
+    {
+        size_t total = 0;
+        for (auto word : words_)
+        {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+    /** Keeps only the bits which are also set in a. Bits past the end of a are cleared.
+        @param[in] a Bits to combine with
+        @return This vector */
+    bit_vector& operator&=(const bit_vector& a) noexcept
+    {
+        auto common = std::min(words_.size(), a.words_.size());
+        for (size_t i = 0; i < common; ++i)
+        {
+            words_[i] &= a.words_[i];
+        }
+        std::fill(words_.begin() + common, words_.end(), 0);
+        drop_rank_index();
+        return *this;
+    }
+
+    /** Sets the bits which are set in a. Bits of a past the end of this vector are ignored.
+        @param[in] a Bits to combine with
+        @return This vector */
+    bit_vector& operator|=(const bit_vector& a) noexcept
+    {
+        auto common = std::min(words_.size(), a.words_.size());
+        for (size_t i = 0; i < common; ++i)
+        {
+            words_[i] |= a.words_[i];
+        }
+        clear_unused_bits();
+        drop_rank_index();
+        return *this;
+    }
+
+    /** Inverts the bits which are set in a. Bits of a past the end of this vector are ignored.
+        @param[in] a Bits to combine with
+        @return This vector */
+    bit_vector& operator^=(const bit_vector& a) noexcept
+    {
+        auto common = std::min(words_.size(), a.words_.size());
+        for (size_t i = 0; i < common; ++i)
+        {
+            words_[i] ^= a.words_[i];
+        }
+        clear_unused_bits();
+        drop_rank_index();
+        return *this;
+    }
+
+    /** See return
+        @param[in] lhs Left hand side
+        @param[in] rhs Right hand side
+        @return The bits set in both, sized like lhs */
+    friend bit_vector operator&(bit_vector lhs, const bit_vector& rhs)
+    {
+        return lhs &= rhs;
+    }
+
+    /** See return
+        @param[in] lhs Left hand side
+        @param[in] rhs Right hand side
+        @return The bits set in either, sized like lhs */
+    friend bit_vector operator|(bit_vector lhs, const bit_vector& rhs)
+    {
+        return lhs |= rhs;
+    }
+
+    /** See return
+        @param[in] lhs Left hand side
+        @param[in] rhs Right hand side
+        @return The bits set in exactly one, sized like lhs */
+    friend bit_vector operator^(bit_vector lhs, const bit_vector& rhs)
+    {
+        return lhs ^= rhs;
+    }
+
+    /** See return
+        @param[in] lhs Left hand side
+        @param[in] rhs Right hand side
+        @return True if both hold the same bits */
+    friend bool operator==(const bit_vector& lhs, const bit_vector& rhs) noexcept
+    {
+        return lhs.size_ == rhs.size_ && std::equal(lhs.words_.begin(), lhs.words_.end(), rhs.words_.begin());
+    }
+
+    /** Builds the rank index over the current bits, replacing any previous one */
+    void build_rank_index()
+    {
+        ranks_.resize(0);
+        ranks_.reserve(words_.size() / words_per_block + 2);
+
+        // One running total before every block of words, plus the overall total at the end
+        uint64_t total = 0;
+        for (size_t i = 0; i < words_.size(); ++i)
+        {
+            if (i % words_per_block == 0)
+            {
+                ranks_.push_back(total);
+            }
+            total += std::popcount(words_[i]);
+        }
+        ranks_.push_back(total);
+    }
+
+    /** See return
+        @return True if the rank index has been built since the vector was last changed through a member function */
+    bool has_rank_index() const noexcept
+    {
+        return !ranks_.empty();
+    }
+
+    /** Counts the set bits before a position. Constant time with the rank index, linear without.
+        @param[in] index Position to count up to, at most size()
+        @return Amount of set bits in [0, index) */
+    size_t rank(size_t index) const noexcept
+    {
+        auto word = index / word_bits;
+        size_t first = 0;
+        size_t total = 0;
+        if (has_rank_index())
+        {
+            first = word / words_per_block * words_per_block;
+            total = ranks_[word / words_per_block];
+        }
+
+        for (auto i = first; i < word; ++i)
+        {
+            total += std::popcount(words_[i]);
+        }
+        if (index % word_bits != 0)
+        {
+            total += std::popcount(words_[word] & (bit(index) - 1));
+        }
+        return total;
+    }
+
+    /** Finds a set bit by its rank. Logarithmic time with the rank index, linear without.
+        @param[in] k Amount of set bits before the one wanted
+        @return Index of the set bit with rank k, or size() if fewer than k + 1 bits are set */
+    size_t select(size_t k) const noexcept
+    {
+        size_t word = 0;
+        if (has_rank_index())
+        {
+            if (k >= ranks_[ranks_.size() - 1])
+            {
+                return size_;
+            }
+
+            // The last block starting with at most k set bits before it holds the bit
+            auto block = std::upper_bound(ranks_.begin(), ranks_.end(), k) - ranks_.begin() - 1;
+            k -= ranks_[block];
+            word = block * words_per_block;
+        }
+
+        for (; word < words_.size(); ++word)
+        {
+            size_t ones = std::popcount(words_[word]);
+            if (k < ones)
+            {
+                // Drop the lowest k set bits, leaving the wanted one lowest
+                auto bits = words_[word];
+                for (; k > 0; --k)
+                {
+                    bits &= bits - 1;
+                }
+                return word * word_bits + std::countr_zero(bits);
+            }
+            k -= ones;
+        }
+        return size_;
+    }
+
+    /** See return
+        @return Amount of bits stored */
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 bit stored */
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /** See return
+        @return The words holding the bits, lowest index in the lowest bit of the first word */
+    std::span<const uint64_t> words() const noexcept
+    {
+        return std::span<const uint64_t>(words_.data(), words_.size());
+    }
+
+private:
+    custom_vector<uint64_t> words_;
+    custom_vector<uint64_t> ranks_;
+    size_t size_;
+
+    /** See return
+        @param[in] count Amount of bits
+        @return Amount of words needed to hold count bits */
+    static constexpr size_t words_for(size_t count) noexcept
+    {
+        return (count + word_bits - 1) / word_bits;
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return Mask selecting the bit within its word */
+    static constexpr uint64_t bit(size_t index) noexcept
+    {
+        return uint64_t(1) << (index % word_bits);
+    }
+
+    /** Sets or clears every bit in [first, last), handling partial words at either end with masks
+        @param[in] first Index of the first bit
+        @param[in] last Index 1 past the last bit
+        @param[in] value Value to give the bits */
+    void fill(size_t first, size_t last, bool value) noexcept
+    {
+        if (first >= last)
+        {
+            return;
+        }
+
+        auto apply = [value](uint64_t& word, uint64_t mask)
+        {
+            word = value ? (word | mask) : (word & ~mask);
+        };
+
+        auto first_word = first / word_bits;
+        auto last_word = (last - 1) / word_bits;
+        auto head = ~uint64_t(0) << (first % word_bits);
+        auto tail = ~uint64_t(0) >> (word_bits - 1 - (last - 1) % word_bits);
+        if (first_word == last_word)
+        {
+            apply(words_[first_word], head & tail);
+            return;
+        }
+
+        apply(words_[first_word], head);
+        std::fill(words_.begin() + first_word + 1, words_.begin() + last_word, value ? ~uint64_t(0) : 0);
+        apply(words_[last_word], tail);
+    }
+
+    /** Clears the bits of the last word which lie past the end of the vector */
+    void clear_unused_bits() noexcept
+    {
+        if (size_ % word_bits != 0)
+        {
+            words_[words_.size() - 1] &= bit(size_) - 1;
+        }
+    }
+
+    /** Drops the rank index, keeping its memory for when it's rebuilt */
+    void drop_rank_index() noexcept
+    {
+        ranks_.resize(0);
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "concurrent_filler.h"
+#include "custom_vector.h"
+#include "memory_policy.h"
+
+/** Gives every thread its own vector to append to, then concatenates them all into one vector.
+    combine() works out where each thread's objects go, reserves the destination once, and relocates every
+    buffer into place in parallel. Objects end up ordered by buffer key. local() hands out keys in the order
+    threads first ask for a buffer, which may differ between runs. For a deterministic order, ask for buffers
+    with local(key) using a stable key such as a worker index instead. Don't mix the two. */
+template <typename T>
+class combinable_vector
+{
+public:
+    /** Default constructor */
+    combinable_vector() : id_(next_id()) {}
+
+    combinable_vector(const combinable_vector&) = delete;
+    combinable_vector& operator=(const combinable_vector&) = delete;
+
+    /** Gets the calling thread's buffer, creating it on first use. Thread safe.
+        @return The calling thread's buffer */
+    custom_vector<T>& local()
+    {
+        // Repeated calls from one thread skip the lock entirely
+        thread_local cache last{ 0, nullptr };
+        if (last.id == id_)
+        {
+            return *last.buffer;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto this_thread = std::this_thread::get_id();
+        auto it = std::find_if(buffers_.begin(), buffers_.end(), [&](const entry& e) { return e.thread == this_thread; });
+        if (it == buffers_.end())
+        {
+            buffers_.emplace_back(entry{ this_thread, buffers_.size(), std::make_unique<custom_vector<T>>() });
+            it = buffers_.end() - 1;
+        }
+
+        last = cache{ id_, it->buffer.get() };
+        return *it->buffer;
+    }
+
+    /** Gets the buffer for the given key, creating it on first use. Thread safe.
+        @param[in] key Position of the buffer in the combined output, relative to other keys
+        @return The buffer for the key */
+    custom_vector<T>& local(size_t key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(buffers_.begin(), buffers_.end(), [&](const entry& e) { return e.key == key; });
+        if (it == buffers_.end())
+        {
+            buffers_.emplace_back(entry{ std::thread::id(), key, std::make_unique<custom_vector<T>>() });
+            it = buffers_.end() - 1;
+        }
+
+        return *it->buffer;
+    }
+
+    /** Appends every buffer's objects to out, ordered by key, and empties the buffers while keeping their memory.
+        @note No thread may use its buffer during the call.
+        @param[in, out] out Vector to append to */
+    void combine(custom_vector<T>& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::sort(buffers_.begin(), buffers_.end(), [](const entry& lhs, const entry& rhs) { return lhs.key < rhs.key; });
+
+        size_t total = 0;
+        custom_vector<size_t> offsets(buffers_.size());
+        for (auto& e : buffers_)
+        {
+            offsets.push_back(total);
+            total += e.buffer->size();
+        }
+
+        concurrent_filler<T> filler(out, total);
+        auto relocate = [&](size_t i)
+        {
+            auto& buffer = *buffers_[i].buffer;
+            auto slots = filler.claim_at(offsets[i], buffer.size());
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (!slots.empty())
+                {
+                    std::memcpy(static_cast<void*>(slots.data()), buffer.data(), slots.size_bytes());
+                }
+            }
+            else
+            {
+                std::uninitialized_move(buffer.begin(), buffer.end(), slots.begin());
+            }
+            filler.constructed(slots.size());
+            while (!buffer.empty())
+            {
+                buffer.pop_back();
+            }
+        };
+
+        // Small amounts aren't worth starting threads for, and moves which may throw can't run on other threads.
+        // Otherwise buffers are shared out among at most one thread per hardware thread.
+        constexpr bool nothrow_relocate = std::is_trivially_copyable_v<T> || std::is_nothrow_move_constructible_v<T>;
+        if (!nothrow_relocate || total * sizeof(T) < parallel_threshold_bytes)
+        {
+            for (size_t i = 0; i < buffers_.size(); ++i)
+            {
+                relocate(i);
+            }
+        }
+        else
+        {
+            memory_policy::for_each_partition(buffers_.size(), [&relocate](size_t first, size_t last)
+            {
+                for (auto i = first; i < last; ++i)
+                {
+                    relocate(i);
+                }
+            });
+        }
+
+        filler.commit();
+    }
+
+    /** See return
+        @return A new vector holding every buffer's objects, ordered by key */
+    custom_vector<T> combine()
+    {
+        custom_vector<T> out;
+        combine(out);
+        return out;
+    }
+
+private:
+    static constexpr size_t parallel_threshold_bytes = 1 << 20;
+
+    struct entry
+    {
+        std::thread::id thread;
+        size_t key;
+        std::unique_ptr<custom_vector<T>> buffer;
+    };
+
+    struct cache
+    {
+        uint64_t id;
+        custom_vector<T>* buffer;
+    };
+
+    uint64_t id_;
+    std::mutex mutex_;
+    custom_vector<entry> buffers_;
+
+    /** See return
+        @return An id which no other combinable_vector has had, so stale thread caches never match */
+    static uint64_t next_id() noexcept
+    {
+        static std::atomic<uint64_t> id = 0;
+        return ++id;
+    }
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+
+#include "custom_vector.h"
+
+/** Lets many threads construct objects at the end of one vector at the same time, without locks or merging.
+    The vector reserves room for every object up front. Threads then claim uninitialized slots with an atomic
+    fetch-add, construct objects in them, and report how many they constructed. commit() waits for every claimed
+    slot to be constructed and then publishes them as the vector's new size.
+
+    Nothing else may touch the vector between construction of the filler and commit(). A filler destroyed without
+    commit(), e.g. by an early return or an exception, commits on destruction, so the objects constructed so far
+    belong to the vector and are destroyed with it rather than leaked. */
+template <typename T, class Allocator = std::allocator<T>>
+class concurrent_filler
+{
+public:
+    /** Constructor. Reserves room for count more objects.
+        @param[in, out] vec Vector to fill
+        @param[in] count Amount of objects which will be added */
+    concurrent_filler(custom_vector<T, Allocator>& vec, size_t count) :
+        vec_(vec), first_(vec.size()), limit_(count), claimed_(0), constructed_(0), committed_(false)
+    {
+        vec_.reserve(first_ + count);
+    }
+
+    /** Destructor. Commits if commit() wasn't called, waiting for outstanding claims first.
+        @note Every claimed slot must still be constructed and reported, or this waits forever */
+    ~concurrent_filler()
+    {
+        if (!committed_)
+        {
+            commit();
+        }
+    }
+
+    concurrent_filler(const concurrent_filler&) = delete;
+    concurrent_filler& operator=(const concurrent_filler&) = delete;
+
+    /** Claims uninitialized slots for the calling thread. Thread safe and lock-free.
+        @note Every slot handed out must be constructed, e.g. with std::construct_at, and then reported with constructed().
+        @param[in] n Amount of slots wanted
+        @return Up to n uninitialized slots. Fewer, or none, once the reserved room runs out */
+    std::span<T> claim_n(size_t n) noexcept
+    {
+        auto offset = claimed_.fetch_add(n, std::memory_order_relaxed);
+        if (offset >= limit_)
+        {
+            return {};
+        }
+
+        return std::span<T>(vec_.data() + first_ + offset, std::min(n, limit_ - offset));
+    }
+
+    /** Claims specific uninitialized slots, for callers which already partitioned the output among themselves.
+        @note Must not be mixed with claim_n(). Claimed ranges must not overlap.
+        @param[in] offset Index of the first slot, relative to where the filler started
+        @param[in] n Amount of slots wanted
+        @return Up to n uninitialized slots. Fewer, or none, past the end of the reserved room */
+    std::span<T> claim_at(size_t offset, size_t n) noexcept
+    {
+        if (offset >= limit_)
+        {
+            return {};
+        }
+
+        auto count = std::min(n, limit_ - offset);
+        claimed_.fetch_add(count, std::memory_order_relaxed);
+        return std::span<T>(vec_.data() + first_ + offset, count);
+    }
+
+    /** Reports objects constructed in claimed slots. Thread safe.
+        @param[in] n Amount of objects constructed */
+    void constructed(size_t n) noexcept
+    {
+        constructed_.fetch_add(n, std::memory_order_release);
+        constructed_.notify_all();
+    }
+
+    /** Waits until every claimed slot has been constructed, then publishes them as the vector's new size.
+        @note Must be called once claiming has finished, although construction may still be in progress.
+        @return Amount of objects added to the vector */
+    size_t commit() noexcept
+    {
+        auto target = std::min(claimed_.load(std::memory_order_relaxed), limit_);
+        for (auto done = constructed_.load(std::memory_order_acquire); done != target; done = constructed_.load(std::memory_order_acquire))
+        {
+            constructed_.wait(done, std::memory_order_acquire);
+        }
+
+        vec_.end_ = vec_.begin_ + first_ + target;
+        committed_ = true;
+        return target;
+    }
+
+private:
+    custom_vector<T, Allocator>& vec_;
+    size_t first_;
+    size_t limit_;
+    std::atomic<size_t> claimed_;
+    std::atomic<size_t> constructed_;
+    bool committed_;
+};
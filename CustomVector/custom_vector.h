@@ -1,61 +1,184 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <ranges>
+#include <span>
 #include <type_traits>
 #include <utility>
 
+#include "memory_policy.h"
+#include "vector_core.h"
+
+// Builds without exception support get no try/catch at all. Failing to grow then aborts instead of throwing
+// std::bad_alloc, so use the try_ functions where running out of memory must be handled.
+#if !defined(CUSTOM_VECTOR_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(_CPPUNWIND)
+#define CUSTOM_VECTOR_NO_EXCEPTIONS
+#endif
+
+template <typename T, class Allocator>
+class concurrent_filler;
+
 template <typename T, class Allocator = std::allocator<T>>
 class custom_vector
 {
+    template <typename, class>
+    friend class concurrent_filler;
+
 public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+
+    // Plain pointers are contiguous iterators, so standard algorithms can use their memmove fast paths
     using iterator_t = T*;
-    using const_iterator_t = const iterator_t;
+    using const_iterator_t = const T*;
+    using iterator = iterator_t;
+    using const_iterator = const_iterator_t;
+
+    static_assert(std::contiguous_iterator<iterator>);
+    static_assert(std::contiguous_iterator<const_iterator>);
+
+    /** Function which frees a buffer of the given capacity once its objects have been destroyed */
+    using deleter_t = void (*)(T* buffer, size_t capacity);
+
+    /** A buffer whose ownership has been given up by a vector */
+    struct released_buffer
+    {
+        T* data;            ///< First object, or nullptr if the vector held no memory
+        size_t size;        ///< Amount of constructed objects at the front of the buffer
+        size_t capacity;    ///< Amount of objects the buffer has room for
+        deleter_t deleter;  ///< Frees the buffer. Objects must be destroyed before calling it
+    };
 
     /** Default constructor */
-    custom_vector() : begin_(nullptr), end_(nullptr), tail_(nullptr) {}
+    constexpr custom_vector() : begin_(nullptr), end_(nullptr), tail_(nullptr), deleter_(&default_deleter), locked_(false) {}
+
+    /** Constructor which sets the memory options used for every buffer the vector allocates
+        @param[in] options Memory options for the vector */
+    explicit constexpr custom_vector(const memory_options& options) : custom_vector()
+    {
+        options_ = options;
+    }
 
     /** Constructor which allocates memory
         @note No objects are constructed except the vector itself.
         @param[in] capacity Amount of objects which the vector could potentially hold. */
-    custom_vector(size_t capacity) : custom_vector()
+    constexpr custom_vector(size_t capacity) : custom_vector()
     {
-        reallocate(capacity);
+        reserve(capacity);
     }
 
     /** Constructor which allocates memory and copies objects.
         @param[in] capacity Amount of objects which the vector could potentially hold. */
-    custom_vector(size_t capacity, const T& t) : custom_vector(capacity)
+    constexpr custom_vector(size_t capacity, const T& t) : custom_vector(capacity, t, memory_options{}) {}
+
+    /** Constructor which allocates memory and copies objects, using the given memory options.
+        @note With a NUMA policy, large fills are constructed by several threads so pages are first touched where they belong.
+        @param[in] capacity Amount of objects which the vector could potentially hold.
+        @param[in] t Object to copy into every position
+        @param[in] options Memory options for the vector */
+    constexpr custom_vector(size_t capacity, const T& t, const memory_options& options) : custom_vector(options)
     {
-        for (auto it = begin_; it != tail_; ++it)
-        {
-            new (as_t(it)) T{ t };
-        }
-        end_ = tail_;
+        reserve(capacity);
+        construct_to(capacity, std::is_nothrow_copy_constructible_v<T>, [&t](T* it) { std::construct_at(it, t); });
     }
 
-    /** Copy constructor */
-    custom_vector(const custom_vector& a) : custom_vector(a.capacity())
+    /** Constructor which copies objects from an iterator range, allocating at most once when the distance is known.
+        @param[in] first Iterator to the first object to copy
+        @param[in] last Sentinel 1 past the last object to copy */
+    template <std::input_iterator It, std::sentinel_for<It> S>
+    constexpr custom_vector(It first, S last) : custom_vector()
     {
-        std::uninitialized_copy(a.cbegin(), a.cend(), as_t(begin_));
-        end_ = begin_ + a.size();
+        append_range(std::ranges::subrange(std::move(first), std::move(last)));
     }
 
-    /** Copy assignment operator */
-    custom_vector& operator=(custom_vector a)
+#if defined(__cpp_lib_containers_ranges)
+    /** Range constructor used by std::ranges::to<custom_vector>()
+        @param[in] r Range of objects to copy */
+    template <std::ranges::input_range R>
+    constexpr custom_vector(std::from_range_t, R&& r) : custom_vector()
     {
-        swap(a);
+        append_range(std::forward<R>(r));
+    }
+#endif
+
+    /** Copy constructor
+        @note Allocates exactly enough for the objects copied, regardless of the capacity of a */
+    constexpr custom_vector(const custom_vector& a) : custom_vector(a.options_)
+    {
+        append_range(a);
+    }
+
+    /** Copy assignment operator
+        Assigns over existing objects and only allocates if the current capacity is too small, so copying into
+        the same vector repeatedly stops allocating once it is large enough. The memory options are kept. */
+    constexpr custom_vector& operator=(const custom_vector& a)
+    {
+        if (this == &a)
+        {
+            return *this;
+        }
+
+        // Without room for every object there's nothing worth keeping, so drop the objects before reallocating
+        if (a.size() > capacity())
+        {
+            std::destroy(begin_, end_);
+            end_ = begin_;
+            reserve(a.size());
+        }
+
+        // Objects which can't be assigned are replaced instead
+        if constexpr (std::is_copy_assignable_v<T>)
+        {
+            std::copy(a.cbegin(), a.cbegin() + std::min(size(), a.size()), begin_);
+        }
+        else
+        {
+            std::destroy(begin_, end_);
+            end_ = begin_;
+        }
+
+        auto common = std::min(size(), a.size());
+        if (a.size() > common)
+        {
+            append_range(std::ranges::subrange(a.cbegin() + common, a.cend()));
+        }
+        else
+        {
+            std::destroy(begin_ + common, end_);
+            end_ = begin_ + common;
+        }
+
         return *this;
     }
 
     /** Move constructor */
-    custom_vector(custom_vector&& a) noexcept : custom_vector()
+    constexpr custom_vector(custom_vector&& a) noexcept : custom_vector()
     {
         swap(a);
     }
 
+    /** Move assignment operator */
+    constexpr custom_vector& operator=(custom_vector&& a) noexcept
+    {
+        if (this != &a)
+        {
+            clear();
+            swap(a);
+        }
+        return *this;
+    }
+
     /** Destructor */
-    ~custom_vector()
+    constexpr ~custom_vector()
     {
         clear();
     }
@@ -66,12 +189,15 @@ public:
         Performs a lightweight swap of two objects for general use or for the copy-swap idiom
         @param[in, out] lhs Left hand side of the swap
         @param[in, out] rhs Right hand side of the swap */
-    void swap(custom_vector& a) noexcept
+    constexpr void swap(custom_vector& a) noexcept
     {
         using std::swap;
         swap(begin_, a.begin_);
         swap(end_, a.end_);
         swap(tail_, a.tail_);
+        swap(deleter_, a.deleter_);
+        swap(options_, a.options_);
+        swap(locked_, a.locked_);
     }
 
     /** Swap function
@@ -79,7 +205,7 @@ public:
         @note Friend version for generic support
         @param[in, out] lhs Left hand side of the swap
         @param[in, out] rhs Right hand side of the swap */
-    friend void swap(custom_vector& lhs, custom_vector& rhs) noexcept
+    friend constexpr void swap(custom_vector& lhs, custom_vector& rhs) noexcept
     {
         lhs.swap(rhs);
     }
@@ -87,115 +213,396 @@ public:
     /** Indexing operator
         @param[in] index Offset into the vector
         @return The object at the index given */
-    T& operator[] (size_t index) const
+    constexpr T& operator[] (size_t index)
     {
-        return *as_t(begin_ + index);
+        return begin_[index];
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The constant object at the index given */
+    constexpr const T& operator[] (size_t index) const
+    {
+        return begin_[index];
     }
 
     /** Adds an object to the vector, allocating memory as needed.
+        @note Throws std::bad_alloc (or aborts without exceptions) if memory can't be allocated
         @param[in] t Generic object to add to the vector */
-    void push_back(const T& t)
+    constexpr void push_back(const T& t)
     {
         scale_if_required();
-        new (as_t(end_++)) T{ t };
+        std::construct_at(end_++, t);
+    }
+
+    /** Adds an object to the vector, allocating memory as needed.
+        @param[in] t Generic object to add to the vector
+        @return False, leaving the vector unchanged, if memory couldn't be allocated */
+    [[nodiscard]] constexpr bool try_push_back(const T& t)
+    {
+        if (!try_scale_if_required())
+        {
+            return false;
+        }
+        std::construct_at(end_++, t);
+        return true;
     }
 
     /** Emplaces an object to the vector, allocating memory as needed.
         @note This avoids copying temporary objects and is generally more efficient than push_back
+        @note Throws std::bad_alloc (or aborts without exceptions) if memory can't be allocated
         @param[in] t Generic object to add to the vector */
     template <typename... Args>
-    void emplace_back(Args&&... args)
+    constexpr void emplace_back(Args&&... args)
     {
         scale_if_required();
-        new (as_t(end_++)) T{ std::forward<Args>(args)... };
+        std::construct_at(end_++, std::forward<Args>(args)...);
+    }
+
+    /** Emplaces an object to the vector, allocating memory as needed.
+        @param[in] t Generic object to add to the vector
+        @return False, leaving the vector unchanged, if memory couldn't be allocated */
+    template <typename... Args>
+    [[nodiscard]] constexpr bool try_emplace_back(Args&&... args)
+    {
+        if (!try_scale_if_required())
+        {
+            return false;
+        }
+        std::construct_at(end_++, std::forward<Args>(args)...);
+        return true;
+    }
+
+    /** Destroys the last object. Never reduces capacity.
+        @note The vector must not be empty */
+    constexpr void pop_back() noexcept
+    {
+        std::destroy_at(--end_);
+    }
+
+    /** Constructs a copy of each object in the range at the end of the vector.
+        @note Sized ranges allocate at most once, growing geometrically so repeated appends stay linear. Other ranges
+              grow as push_back would.
+        @param[in] r Range of objects to add to the vector */
+    template <std::ranges::input_range R>
+    constexpr void append_range(R&& r)
+    {
+        if constexpr (std::ranges::sized_range<R>)
+        {
+            grow_to(size() + std::ranges::size(r));
+            for (auto&& t : r)
+            {
+                std::construct_at(end_, std::forward<decltype(t)>(t));
+                ++end_;
+            }
+        }
+        else
+        {
+            for (auto&& t : r)
+            {
+                emplace_back(std::forward<decltype(t)>(t));
+            }
+        }
+    }
+
+    /** Materializes a range, such as a lazy view pipeline, into a new vector.
+        @note Sized ranges allocate exactly once. For other ranges size_hint should be an upper bound on the
+              amount of objects; the vector is trimmed to fit afterwards, so at most one extra reallocation occurs.
+        @param[in] r Range of objects to copy
+        @param[in] size_hint Expected maximum amount of objects, ignored for sized ranges
+        @return A vector holding a copy of every object in the range */
+    template <std::ranges::input_range R>
+    static constexpr custom_vector from_range(R&& r, size_t size_hint = 0)
+    {
+        custom_vector vec;
+
+        if constexpr (std::ranges::sized_range<R>)
+        {
+            vec.append_range(std::forward<R>(r));
+        }
+        else
+        {
+            vec.reserve(size_hint);
+            vec.append_range(std::forward<R>(r));
+            vec.shrink_to_fit();
+        }
+
+        return vec;
     }
 
     /** Destructs all objects and deallocates memory */
-    void clear() noexcept
+    constexpr void clear() noexcept
+    {
+        std::destroy(begin_, end_);
+        free_storage(begin_, capacity());
+        begin_ = nullptr;
+        end_ = nullptr;
+        tail_ = nullptr;
+        deleter_ = &default_deleter;
+        locked_ = false;
+    }
+
+    /** Takes ownership of an existing buffer without copying or moving its objects. Any current contents are cleared.
+        @note The first size objects of the buffer must already be constructed and the buffer must be suitably aligned for T.
+        @param[in] buffer First object of the buffer
+        @param[in] size Amount of constructed objects at the front of the buffer
+        @param[in] capacity Amount of objects the buffer has room for
+        @param[in] deleter Frees the buffer when the vector is done with it, e.g. after growing or on destruction */
+    constexpr void adopt(T* buffer, size_t size, size_t capacity, deleter_t deleter) noexcept
     {
-        std::destroy(as_t(begin_), as_t(end_));
-        delete[] begin_;
+        clear();
+        begin_ = buffer;
+        end_ = begin_ + size;
+        tail_ = begin_ + capacity;
+        deleter_ = deleter;
+    }
+
+    /** Gives up ownership of the buffer without destroying its objects. The vector is left empty.
+        @note The caller becomes responsible for destroying the objects and then calling the returned deleter.
+        @return The buffer along with its size, capacity and the function which frees it */
+    constexpr released_buffer release() noexcept
+    {
+        unlock_storage(begin_, capacity());
+        released_buffer buffer{ data(), size(), capacity(), deleter_ };
         begin_ = nullptr;
         end_ = nullptr;
         tail_ = nullptr;
+        deleter_ = &default_deleter;
+        locked_ = false;
+        return buffer;
+    }
+
+    /** Frees a buffer which was allocated by a vector. Handed out by release() for buffers the vector allocated itself.
+        @param[in] buffer First object of the buffer
+        @param[in] capacity Amount of objects the buffer has room for */
+    static constexpr void default_deleter(T* buffer, size_t capacity) noexcept
+    {
+        if (std::is_constant_evaluated())
+        {
+            std::allocator<T>().deallocate(buffer, capacity);
+        }
+        else
+        {
+            vector_core::deallocate(buffer, alignof(T));
+        }
     }
 
     /** See return
         @return Amount of objects stored by the vector */
-    size_t size() const noexcept
+    constexpr size_t size() const noexcept
     {
         return (begin_ && end_) ? std::distance(begin_, end_) : 0;
     }
 
     /** See return
         @return Potential amount of objects the vector may store */
-    size_t capacity() const noexcept
+    constexpr size_t capacity() const noexcept
     {
         return (begin_ && tail_) ? std::distance(begin_, tail_) : 0;
     }
 
     /** See return
         @return True if the vector currently has at least 1 object stored */
-    bool empty() const noexcept
+    constexpr bool empty() const noexcept
     {
         return size() == 0;
     }
 
     /** Increases capacity if the new capacity is greater than the current. Never reduces capacity.
+        @note Throws std::bad_alloc (or aborts without exceptions) if memory can't be allocated
         @param[in] new_cap New capacity for the vector */
-    void reserve(size_t new_cap)
+    constexpr void reserve(size_t new_cap)
+    {
+        if (!try_reserve(new_cap))
+        {
+            out_of_memory();
+        }
+    }
+
+    /** Increases capacity if the new capacity is greater than the current. Never reduces capacity.
+        @param[in] new_cap New capacity for the vector
+        @return False, leaving the vector unchanged, if memory couldn't be allocated */
+    [[nodiscard]] constexpr bool try_reserve(size_t new_cap)
+    {
+        return new_cap <= capacity() || reallocate(new_cap);
+    }
+
+    /** Changes the amount of objects stored. New objects are value initialized and extra objects destroyed.
+        @note Never reduces capacity.
+        @param[in] new_size New amount of objects */
+    constexpr void resize(size_t new_size)
     {
-        if (new_cap > capacity())
+        if (new_size < size())
         {
-            reallocate(new_cap);
+            std::destroy(begin_ + new_size, end_);
+            end_ = begin_ + new_size;
+            return;
+        }
+
+        grow_to(new_size);
+        construct_to(new_size, std::is_nothrow_default_constructible_v<T>, [](T* it) { std::construct_at(it); });
+    }
+
+    /** Changes the amount of objects stored. New objects are copies of t and extra objects are destroyed.
+        @note Never reduces capacity.
+        @param[in] new_size New amount of objects
+        @param[in] t Object to copy into new positions */
+    constexpr void resize(size_t new_size, const T& t)
+    {
+        if (new_size < size())
+        {
+            std::destroy(begin_ + new_size, end_);
+            end_ = begin_ + new_size;
+            return;
+        }
+
+        grow_to(new_size);
+        construct_to(new_size, std::is_nothrow_copy_constructible_v<T>, [&t](T* it) { std::construct_at(it, t); });
+    }
+
+    /** Sets the memory options for the vector, then increases capacity as reserve(new_cap) would.
+        @note The options apply to this and every later allocation. They don't affect the current buffer.
+        @param[in] new_cap New capacity for the vector
+        @param[in] options Memory options for the vector */
+    constexpr void reserve(size_t new_cap, const memory_options& options)
+    {
+        options_ = options;
+        reserve(new_cap);
+    }
+
+    /** Sets the memory options used for every buffer the vector allocates from now on
+        @param[in] options Memory options for the vector */
+    constexpr void set_memory_options(const memory_options& options) noexcept
+    {
+        options_ = options;
+    }
+
+    /** See return
+        @return The memory options used for every buffer the vector allocates */
+    constexpr const memory_options& get_memory_options() const noexcept
+    {
+        return options_;
+    }
+
+    /** Reduces capacity to the amount of objects currently stored. Empty vectors release all memory. */
+    constexpr void shrink_to_fit()
+    {
+        if (empty())
+        {
+            clear();
+        }
+        else if (capacity() > size())
+        {
+            // Shrinking is only a request, so there's nothing to report if it can't be done
+            (void)reallocate(size());
         }
     }
 
     /** See return
         @return Returns a pointer to the first item in the vector */
-    T* data() const noexcept
+    constexpr T* data() noexcept
     {
-        return as_t(begin_);
+        return begin_;
+    }
+
+    /** See return
+        @return Returns a constant pointer to the first item in the vector */
+    constexpr const T* data() const noexcept
+    {
+        return begin_;
     }
 
     /** See return
         @return Returns the iterator to the first item in the vector */
-    iterator_t begin() const noexcept
+    constexpr iterator_t begin() noexcept
     {
-        return as_t(begin_);
+        return begin_;
     }
 
     /** See return
         @return Returns the iterator to 1 past the last item in the vector */
-    iterator_t end() const noexcept
+    constexpr iterator_t end() noexcept
     {
-        return as_t(end_);
+        return end_;
     }
 
     /** See return
         @return Returns the constant iterator to the first item in the vector */
-    const_iterator_t cbegin() const noexcept
+    constexpr const_iterator_t begin() const noexcept
     {
-        return as_t(begin_);
+        return begin_;
     }
 
     /** See return
         @return Returns the constant iterator to 1 past the last item in the vector */
-    const_iterator_t cend() const noexcept
+    constexpr const_iterator_t end() const noexcept
     {
-        return as_t(end_);
+        return end_;
     }
 
-private:
-    using data_t = std::aligned_storage_t<sizeof(T), alignof(T)>;
+    /** See return
+        @return Returns the constant iterator to the first item in the vector */
+    constexpr const_iterator_t cbegin() const noexcept
+    {
+        return begin_;
+    }
 
-    data_t* begin_;
-    data_t* end_;
-    data_t* tail_;
+    /** See return
+        @return Returns the constant iterator to 1 past the last item in the vector */
+    constexpr const_iterator_t cend() const noexcept
+    {
+        return end_;
+    }
+
+    /** Creates a non-owning view over part of the vector. No objects are copied.
+        @note The view is invalidated by anything which reallocates the vector.
+        @param[in] offset Index of the first object in the view
+        @param[in] count Amount of objects in the view, or the rest of the vector if omitted
+        @return A view over [offset, offset + count) */
+    constexpr std::span<T> subspan(size_t offset, size_t count = std::dynamic_extent) noexcept
+    {
+        return std::span<T>(data(), size()).subspan(offset, count);
+    }
+
+    /** Creates a non-owning constant view over part of the vector. No objects are copied.
+        @note The view is invalidated by anything which reallocates the vector.
+        @param[in] offset Index of the first object in the view
+        @param[in] count Amount of objects in the view, or the rest of the vector if omitted
+        @return A constant view over [offset, offset + count) */
+    constexpr std::span<const T> subspan(size_t offset, size_t count = std::dynamic_extent) const noexcept
+    {
+        return std::span<const T>(data(), size()).subspan(offset, count);
+    }
+
+    /** Creates a non-owning view over the half open range of indices [first, last).
+        @param[in] first Index of the first object in the view
+        @param[in] last Index 1 past the last object in the view
+        @return A view over [first, last) */
+    constexpr std::span<T> slice(size_t first, size_t last) noexcept
+    {
+        return subspan(first, last - first);
+    }
+
+    /** Creates a non-owning constant view over the half open range of indices [first, last).
+        @param[in] first Index of the first object in the view
+        @param[in] last Index 1 past the last object in the view
+        @return A constant view over [first, last) */
+    constexpr std::span<const T> slice(size_t first, size_t last) const noexcept
+    {
+        return subspan(first, last - first);
+    }
+
+private:
+    T* begin_;
+    T* end_;
+    T* tail_;
+    deleter_t deleter_;
+    memory_options options_;
+    bool locked_;
 
     /** Gets a new capacity based on the current capacity and scale factor. Always increases by at least 1.
         @return The new scaled capacity */
-    size_t get_new_scaled_capacity() const noexcept
+    constexpr size_t get_new_scaled_capacity() const noexcept
     {
         auto current_cap = capacity();
         return std::max((size_t)(current_cap * scale_factor()), current_cap + 1);
@@ -203,13 +610,24 @@ private:
 
     /** See return
         @return True if the vector is at capacity and cannot hold even 1 more item */
-    bool full() const noexcept
+    constexpr bool full() const noexcept
     {
         return size() == capacity();
     }
 
+    /** Makes room for at least needed objects. Grows by at least the scale factor, so repeated calls with slowly
+        increasing sizes reallocate only a logarithmic amount of times. Empty vectors get exactly what they need.
+        @param[in] needed Amount of objects the vector must have room for */
+    constexpr void grow_to(size_t needed)
+    {
+        if (needed > capacity())
+        {
+            reserve(std::max(needed, get_new_scaled_capacity()));
+        }
+    }
+
     /** Scales the vector if the vector is full */
-    void scale_if_required()
+    constexpr void scale_if_required()
     {
         if (full())
         {
@@ -217,64 +635,207 @@ private:
         }
     }
 
+    /** Scales the vector if the vector is full
+        @return False if the vector is full and memory couldn't be allocated */
+    constexpr bool try_scale_if_required()
+    {
+        return !full() || try_reserve(get_new_scaled_capacity());
+    }
+
+    /** Reports failure to allocate memory from functions which can't return it */
+    [[noreturn]] static constexpr void out_of_memory()
+    {
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+        std::abort();
+#else
+        throw std::bad_alloc();
+#endif
+    }
+
+    /** Constructs objects at the end of the vector until it holds new_size objects. Capacity must already suffice.
+        With a NUMA policy, large fills are split across threads using the same partitions of the buffer's bytes as
+        the placement policy, with each thread pinned to its partition's node, so every page is first touched on the
+        node it belongs to. Only done when construction can't throw, as exceptions can't cross threads.
+        @param[in] new_size New amount of objects
+        @param[in] nothrow True if construct can't throw
+        @param[in] construct Callable which constructs one object at the address it's given */
+    template <typename Construct>
+    constexpr void construct_to(size_t new_size, bool nothrow, Construct construct)
+    {
+        auto first = begin_ + size();
+        auto count = new_size - size();
+
+        if (!std::is_constant_evaluated() && nothrow && options_.numa != numa_policy::none && count * sizeof(T) >= memory_policy::parallel_first_touch_bytes)
+        {
+            // Each object belongs to the partition holding its first byte. Partitions before the old end have nothing to do.
+            auto base = begin_;
+            auto old_size = size();
+            memory_policy::for_each_partition(capacity() * sizeof(T), [base, old_size, new_size, &construct](size_t from, size_t to)
+            {
+                auto first_index = std::max(old_size, (from + sizeof(T) - 1) / sizeof(T));
+                auto last_index = std::min(new_size, (to + sizeof(T) - 1) / sizeof(T));
+                for (auto i = first_index; i < last_index; ++i)
+                {
+                    construct(base + i);
+                }
+            });
+            end_ = begin_ + new_size;
+            return;
+        }
+
+        for (; end_ != first + count; ++end_)
+        {
+            construct(end_);
+        }
+    }
+
     /** Obtains new memory and moves (or copies) old data to the new memory block. Deletes old data and deallocates memory.
-        @param[in] new_cap The new capacity for the vector */
-    void reallocate(size_t new_cap)
+        @note If moving or copying an object throws, the vector is left unchanged and the exception propagates.
+        @param[in] new_cap The new capacity for the vector
+        @return False, leaving the vector unchanged, if memory couldn't be allocated */
+    CUSTOM_VECTOR_NOINLINE constexpr bool reallocate(size_t new_cap)
+    {
+        // Growing is the slow path, so it stays out of line to keep push_back and friends small where they're inlined.
+        // Trivially copyable objects can be copied as raw bytes by code which every such instantiation shares,
+        // except during constant evaluation, which can't treat objects as raw bytes.
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (std::is_constant_evaluated())
+            {
+                return reallocate_objects(new_cap);
+            }
+
+            auto old_size = size();
+            bool new_locked = false;
+            auto p = vector_core::reallocate_trivial(begin_, old_size, new_cap, sizeof(T), alignof(T), options_, new_locked);
+            if (!p)
+            {
+                return false;
+            }
+
+            free_storage(begin_, capacity());
+            begin_ = static_cast<T*>(p);
+            deleter_ = &default_deleter;
+            locked_ = new_locked;
+            end_ = begin_ + old_size;
+            tail_ = begin_ + new_cap;
+            return true;
+        }
+        else
+        {
+            return reallocate_objects(new_cap);
+        }
+    }
+
+    /** Obtains new memory and moves (or copies) old objects to it one at a time. Deletes old data and deallocates memory.
+        @note If moving or copying an object throws, the vector is left unchanged and the exception propagates.
+        @param[in] new_cap The new capacity for the vector
+        @return False, leaving the vector unchanged, if memory couldn't be allocated */
+    constexpr bool reallocate_objects(size_t new_cap)
     {
         auto old_size = size();
-        auto old_begin = begin_;
+        auto old_cap = capacity();
 
-        // Allocate new memory. If it fails, reset the begin pointer and return.
-        begin_ = new (std::nothrow) data_t[new_cap];
-        if (!begin_)
+        // The vector keeps pointing at its old buffer until the new one is complete, so it's unchanged on any failure
+        auto new_begin = allocate_storage(new_cap);
+        if (!new_begin)
         {
-            begin_ = old_begin;
-            return;
+            return false;
         }
+        auto new_locked = !std::is_constant_evaluated() && memory_policy::apply(new_begin, new_cap * sizeof(T), options_);
 
         // if there are any elements in the vector, they must be moved/copied
-        if (!empty())
+        if (old_size > 0)
         {
-            // Try to move/copy the objects. If it throws an exception (presumedly because a constructor threw it)
-            // destroy the new objects, delete the new memory, reset the begin_ pointer, and return
-            auto new_it = begin_;
-            try
+            auto new_it = new_begin;
+            auto relocate = [&]
             {
-                for (auto old_it = old_begin; old_it != end_; ++old_it, ++new_it)
+                for (auto old_it = begin_; old_it != end_; ++old_it, ++new_it)
                 {
-                    new (as_t(new_it)) T{ std::move_if_noexcept(*as_t(old_it)) };
+                    std::construct_at(new_it, std::move_if_noexcept(*old_it));
                 }
+            };
+
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+            relocate();
+#else
+            // Only types whose relocation can throw pay for a landing pad
+            if constexpr (std::is_nothrow_constructible_v<T, decltype(std::move_if_noexcept(std::declval<T&>()))>)
+            {
+                relocate();
             }
-            catch (std::exception)
+            else
             {
-                std::destroy(as_t(begin_), as_t(new_it));
-                delete[] begin_;
-                begin_ = old_begin;
-                return;
+                // If a constructor throws, destroy the new objects, delete the new memory, and rethrow
+                try
+                {
+                    relocate();
+                }
+                catch (...)
+                {
+                    std::destroy(new_begin, new_it);
+                    if (new_locked)
+                    {
+                        memory_policy::unlock(new_begin, new_cap * sizeof(T));
+                    }
+                    default_deleter(new_begin, new_cap);
+                    throw;
+                }
             }
+#endif
 
             // The old objects must now be destroyed before the memory they occupy can be freed.
-            std::destroy(as_t(old_begin), as_t(end_));
+            std::destroy(begin_, end_);
         }
 
-        delete[] old_begin;
+        free_storage(begin_, old_cap);
+        begin_ = new_begin;
+        deleter_ = &default_deleter;
+        locked_ = new_locked;
         end_ = begin_ + old_size;
         tail_ = begin_ + new_cap;
+        return true;
     }
 
-    /** Launders the raw memory pointer into an object pointer.
-        @param[in] pointer to a block of raw memory
-        @return A safe to use pointer to object memory */
-    T* as_t(data_t* p) const noexcept
+    /** Returns a buffer to whoever provided it
+        @param[in] p Pointer to the buffer, may be nullptr
+        @param[in] cap Capacity of the buffer */
+    constexpr void free_storage(T* p, size_t cap) const noexcept
     {
-        return std::launder(reinterpret_cast<T*>(p));
+        if (p)
+        {
+            unlock_storage(p, cap);
+            deleter_(p, cap);
+        }
+    }
+
+    /** Unlocks the current buffer if the memory options locked it
+        @param[in] p Pointer to the buffer, may be nullptr
+        @param[in] cap Capacity of the buffer */
+    constexpr void unlock_storage(T* p, size_t cap) const noexcept
+    {
+        if (p && locked_)
+        {
+            memory_policy::unlock(p, cap * sizeof(T));
+        }
+    }
+
+    /** Allocates uninitialized memory for objects. Constant evaluation can only allocate through std::allocator.
+        @param[in] count Amount of objects
+        @return The memory, or nullptr if it couldn't be allocated */
+    static constexpr T* allocate_storage(size_t count) noexcept
+    {
+        if (std::is_constant_evaluated())
+        {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T*>(vector_core::allocate(count, sizeof(T), alignof(T)));
     }
 
     /** See return
         @return The constant scale factory by which the vector should expand when full */
-    static const float& scale_factor() noexcept
+    static constexpr float scale_factor() noexcept
     {
-        static const float scale_factor = 1.5;
-        return scale_factor;
+        return 1.5f;
     }
 };
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "custom_vector.h"
+
+/** An append-only vector for sorted integers such as ids and timestamps. Values are grouped into blocks of 128.
+    A full block is sealed: it is stored as its first value (the base) plus each value's distance from the base,
+    packed with just as many bits as the largest distance needs. Dense sequences therefore take a few bits per value.
+
+    Every sealed block has a header with its base, its last value, its bit width and where its packed words start.
+    The headers double as skip pointers, so seeking binary searches the headers and then at most one block.
+    Values are random access, as unpacking one only needs its block's bit width. The last, unsealed block is kept
+    as plain values until it fills up. */
+class delta_vector
+{
+public:
+    /** Amount of values in every block */
+    static constexpr size_t block_size = 128;
+
+    /** Default constructor */
+    delta_vector() = default;
+
+    /** Adds a value to the end of the vector, sealing the last block once it is full
+        @note Values must be added in ascending order
+        @param[in] value Value to add, no less than the last value added */
+    void push_back(uint64_t value)
+    {
+        tail_.push_back(value);
+        if (tail_.size() == block_size)
+        {
+            seal();
+        }
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The value at the index given */
+    uint64_t operator[] (size_t index) const noexcept
+    {
+        auto b = index / block_size;
+        if (b == blocks_.size())
+        {
+            return tail_[index % block_size];
+        }
+        return blocks_[b].base + unpack(blocks_[b], index % block_size);
+    }
+
+    /** Seeks the first value which isn't less than a value, skipping whole blocks using their headers
+        @param[in] value Value to look for
+        @return Index of the first value no less than value, or size() if there is none */
+    size_t lower_bound(uint64_t value) const noexcept
+    {
+        auto it = std::partition_point(blocks_.begin(), blocks_.end(), [value](const block& b) { return b.last < value; });
+        if (it == blocks_.end())
+        {
+            return blocks_.size() * block_size + size_t(std::lower_bound(tail_.begin(), tail_.end(), value) - tail_.begin());
+        }
+
+        size_t first = 0;
+        size_t last = block_size;
+        while (first < last)
+        {
+            auto middle = (first + last) / 2;
+            if (it->base + unpack(*it, middle) < value)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        return size_t(it - blocks_.begin()) * block_size + first;
+    }
+
+    /** Decodes every value and appends them to out, a block at a time
+        @param[in, out] out Vector to append to */
+    void decode(custom_vector<uint64_t>& out) const
+    {
+        auto first = out.size();
+        out.resize(first + size());
+        for (size_t b = 0; b < blocks_.size(); ++b)
+        {
+            decode_block(blocks_[b], out.data() + first + b * block_size);
+        }
+        std::copy(tail_.begin(), tail_.end(), out.data() + first + blocks_.size() * block_size);
+    }
+
+    /** Removes every value and deallocates memory */
+    void clear() noexcept
+    {
+        blocks_.clear();
+        packed_.clear();
+        tail_.clear();
+    }
+
+    /** See return
+        @return Amount of values stored */
+    size_t size() const noexcept
+    {
+        return blocks_.size() * block_size + tail_.size();
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 value stored */
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /** See return
+        @return Bytes used by the stored values, excluding unused capacity */
+    size_t memory_usage() const noexcept
+    {
+        return blocks_.size() * sizeof(block) + packed_.size() * sizeof(uint64_t) + tail_.size() * sizeof(uint64_t);
+    }
+
+private:
+    /** Header of a sealed block */
+    struct block
+    {
+        uint64_t base;      ///< First value of the block
+        uint64_t last;      ///< Last value of the block
+        size_t offset;      ///< Index of the block's first packed word
+        unsigned bits;      ///< Bits per packed distance, 0 to 64
+    };
+
+    custom_vector<block> blocks_;
+    custom_vector<uint64_t> packed_;    ///< 2 * bits words per sealed block, as 128 values of bits bits fill that many
+    custom_vector<uint64_t> tail_;      ///< The unsealed block
+
+    /** Packs the full tail block and clears it */
+    void seal()
+    {
+        auto base = tail_[0];
+        auto last = tail_[block_size - 1];
+        auto bits = unsigned(std::bit_width(last - base));
+        blocks_.push_back(block{ base, last, packed_.size(), bits });
+
+        packed_.resize(packed_.size() + 2 * bits, 0);
+        auto words = packed_.data() + blocks_[blocks_.size() - 1].offset;
+        for (size_t i = 0; bits > 0 && i < block_size; ++i)
+        {
+            auto distance = tail_[i] - base;
+            auto pos = i * bits;
+            auto shift = pos % 64;
+            words[pos / 64] |= distance << shift;
+            if (shift + bits > 64)
+            {
+                words[pos / 64 + 1] |= distance >> (64 - shift);
+            }
+        }
+
+        tail_.resize(0);
+    }
+
+    /** See return
+        @param[in] b Sealed block
+        @param[in] i Index within the block
+        @return Distance of value i from the block's base */
+    uint64_t unpack(const block& b, size_t i) const noexcept
+    {
+        if (b.bits == 0)
+        {
+            return 0;
+        }
+
+        auto words = packed_.data() + b.offset;
+        auto pos = i * b.bits;
+        auto shift = pos % 64;
+        auto distance = words[pos / 64] >> shift;
+        if (shift + b.bits > 64)
+        {
+            distance |= words[pos / 64 + 1] << (64 - shift);
+        }
+        return b.bits == 64 ? distance : distance & ((uint64_t(1) << b.bits) - 1);
+    }
+
+    /** Decodes a whole sealed block in one loop without dependencies between iterations, which compilers can vectorize
+        @param[in] b Sealed block
+        @param[out] out Room for block_size values */
+    void decode_block(const block& b, uint64_t* out) const noexcept
+    {
+        for (size_t i = 0; i < block_size; ++i)
+        {
+            out[i] = b.base + unpack(b, i);
+        }
+    }
+};
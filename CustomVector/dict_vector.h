@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "bit_vector.h"
+#include "custom_vector.h"
+
+/** A vector for columns with few distinct values repeated many times. Every distinct value is stored once in a
+    dictionary and each position holds only a code indexing it. Codes start at 8 bits and are widened to 16 and then
+    32 bits when the dictionary outgrows them, so a column with a few hundred distinct values costs 2 bytes per entry.
+
+    Values are looked up in the dictionary through an open addressing hash table with linear probing. Filters look the
+    wanted value up once and then compare codes, never touching the values themselves. */
+template <typename T = std::string>
+class dict_vector
+{
+public:
+    /** Default constructor */
+    dict_vector() = default;
+
+    /** Adds a value to the end of the vector, adding it to the dictionary if it's new
+        @param[in] t Value to add */
+    void push_back(const T& t)
+    {
+        auto code = intern(t);
+        std::visit([code](auto& codes)
+        {
+            codes.push_back(static_cast<typename std::remove_reference_t<decltype(codes)>::value_type>(code));
+        }, codes_);
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The value at the index given, which lives in the dictionary */
+    const T& operator[] (size_t index) const noexcept
+    {
+        return dictionary_[code(index)];
+    }
+
+    /** Decodes a string without allocating
+        @param[in] index Offset into the vector
+        @return A view of the string at the index given, valid for as long as the vector */
+    std::string_view view(size_t index) const noexcept requires std::is_convertible_v<const T&, std::string_view>
+    {
+        return dictionary_[code(index)];
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return The dictionary code of the value at the index given */
+    uint32_t code(size_t index) const noexcept
+    {
+        return std::visit([index](const auto& codes) { return uint32_t(codes[index]); }, codes_);
+    }
+
+    /** Looks a value up in the dictionary
+        @param[in] t Value to look for
+        @return The code of the value, or nothing if no position holds it */
+    std::optional<uint32_t> find(const T& t) const
+    {
+        if (slots_.empty())
+        {
+            return std::nullopt;
+        }
+
+        auto hash = std::hash<T>{}(t);
+        auto mask = slots_.size() - 1;
+        for (auto i = hash & mask; slots_[i] != 0; i = (i + 1) & mask)
+        {
+            auto code = slots_[i] - 1;
+            if (hashes_[code] == hash && dictionary_[code] == t)
+            {
+                return code;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /** Finds every position holding a value, comparing codes only
+        @param[in] t Value to look for
+        @return A bitmap with a set bit for every position holding t */
+    bit_vector equal_to(const T& t) const
+    {
+        auto wanted = find(t);
+        if (!wanted)
+        {
+            return bit_vector(size());
+        }
+
+        bit_vector matches;
+        matches.reserve(size());
+        std::visit([&](const auto& codes)
+        {
+            for (auto c : codes)
+            {
+                matches.push_back(c == *wanted);
+            }
+        }, codes_);
+        return matches;
+    }
+
+    /** See return
+        @param[in] t Value to look for
+        @return Amount of positions holding t, counted on codes only */
+    size_t count(const T& t) const
+    {
+        auto wanted = find(t);
+        if (!wanted)
+        {
+            return 0;
+        }
+
+        return std::visit([&](const auto& codes)
+        {
+            return size_t(std::count(codes.begin(), codes.end(), *wanted));
+        }, codes_);
+    }
+
+    /** Increases capacity to hold at least count positions
+        @param[in] count Amount of positions the vector should have room for */
+    void reserve(size_t count)
+    {
+        std::visit([count](auto& codes) { codes.reserve(count); }, codes_);
+    }
+
+    /** Removes every value and the dictionary and deallocates memory */
+    void clear() noexcept
+    {
+        codes_ = custom_vector<uint8_t>();
+        dictionary_.clear();
+        hashes_.clear();
+        slots_.clear();
+    }
+
+    /** See return
+        @return Amount of positions stored */
+    size_t size() const noexcept
+    {
+        return std::visit([](const auto& codes) { return codes.size(); }, codes_);
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 position stored */
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /** See return
+        @return Every distinct value, indexed by code */
+    std::span<const T> dictionary() const noexcept
+    {
+        return std::span<const T>(dictionary_.data(), dictionary_.size());
+    }
+
+    /** See return
+        @return Size of one code in bytes: 1, 2 or 4 */
+    size_t code_size() const noexcept
+    {
+        return std::visit([](const auto& codes) { return sizeof(*codes.data()); }, codes_);
+    }
+
+private:
+    std::variant<custom_vector<uint8_t>, custom_vector<uint16_t>, custom_vector<uint32_t>> codes_;
+    custom_vector<T> dictionary_;
+    custom_vector<size_t> hashes_;  ///< Hash of every dictionary value, so probing and rehashing never hash again
+    custom_vector<uint32_t> slots_; ///< Hash table of codes plus 1, where 0 marks an empty slot
+
+    /** Finds the code of a value, adding it to the dictionary and widening codes if needed
+        @param[in] t Value to look up
+        @return The code of the value */
+    uint32_t intern(const T& t)
+    {
+        // Keep the table at most half full so probe sequences stay short
+        if ((dictionary_.size() + 1) * 2 > slots_.size())
+        {
+            rehash(std::max<size_t>(16, slots_.size() * 2));
+        }
+
+        auto hash = std::hash<T>{}(t);
+        auto mask = slots_.size() - 1;
+        auto i = hash & mask;
+        for (; slots_[i] != 0; i = (i + 1) & mask)
+        {
+            auto code = slots_[i] - 1;
+            if (hashes_[code] == hash && dictionary_[code] == t)
+            {
+                return code;
+            }
+        }
+
+        auto code = uint32_t(dictionary_.size());
+        dictionary_.push_back(t);
+        hashes_.push_back(hash);
+        slots_[i] = code + 1;
+        if (code > max_code())
+        {
+            widen();
+        }
+        return code;
+    }
+
+    /** Rebuilds the hash table with more slots
+        @param[in] slot_count New amount of slots, a power of 2 */
+    void rehash(size_t slot_count)
+    {
+        slots_.resize(0);
+        slots_.resize(slot_count, 0);
+
+        auto mask = slot_count - 1;
+        for (uint32_t code = 0; code < dictionary_.size(); ++code)
+        {
+            auto i = hashes_[code] & mask;
+            while (slots_[i] != 0)
+            {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = code + 1;
+        }
+    }
+
+    /** See return
+        @return Largest code the current code width can hold */
+    uint32_t max_code() const noexcept
+    {
+        return std::visit([](const auto& codes)
+        {
+            return uint32_t(std::numeric_limits<std::remove_cv_t<std::remove_reference_t<decltype(*codes.data())>>>::max());
+        }, codes_);
+    }
+
+    /** Copies the codes into the next wider code type */
+    void widen()
+    {
+        if (auto narrow = std::get_if<custom_vector<uint8_t>>(&codes_))
+        {
+            codes_ = custom_vector<uint16_t>(narrow->begin(), narrow->end());
+        }
+        else if (auto medium = std::get_if<custom_vector<uint16_t>>(&codes_))
+        {
+            codes_ = custom_vector<uint32_t>(medium->begin(), medium->end());
+        }
+    }
+};
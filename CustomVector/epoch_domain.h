@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "custom_vector.h"
+
+/** Epoch-based reclamation. Readers pin the current epoch while they use shared memory and writers retire
+    memory instead of freeing it. Retired memory is only freed once every reader which was pinned when it was
+    retired has unpinned, so a reader may keep using whatever it loaded for as long as it stays pinned.
+
+    Pinning costs one store to a slot which, in the common case, only the pinning thread touches. */
+class epoch_domain
+{
+    static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+    static constexpr size_t slot_count = 64;
+
+public:
+    /** Keeps an epoch pinned for as long as it lives */
+    class guard
+    {
+    public:
+        /** Move constructor */
+        guard(guard&& a) noexcept : slot_(a.slot_)
+        {
+            a.slot_ = nullptr;
+        }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+        guard& operator=(guard&&) = delete;
+
+        /** Destructor. Unpins the epoch. */
+        ~guard()
+        {
+            if (slot_)
+            {
+                slot_->store(idle, std::memory_order_release);
+            }
+        }
+
+    private:
+        friend class epoch_domain;
+
+        std::atomic<uint64_t>* slot_;
+
+        explicit guard(std::atomic<uint64_t>* slot) noexcept : slot_(slot) {}
+    };
+
+    /** Default constructor */
+    epoch_domain() : epoch_(0)
+    {
+        for (auto& slot : slots_)
+        {
+            slot.epoch.store(idle, std::memory_order_relaxed);
+        }
+    }
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    /** Destructor. Frees everything still retired, so no reader may be pinned any more. */
+    ~epoch_domain()
+    {
+        for (auto& r : retired_)
+        {
+            r.reclaim(r.p);
+        }
+    }
+
+    /** See return
+        @return A domain shared by every user which doesn't need its own */
+    static epoch_domain& global()
+    {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    /** Pins the current epoch. Memory loaded from shared pointers afterwards stays valid until the guard is destroyed.
+        @return The guard which keeps the epoch pinned */
+    guard pin() noexcept
+    {
+        // Start where this thread is likely to find its slot from last time
+        thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+        for (;;)
+        {
+            for (size_t i = 0; i < slot_count; ++i)
+            {
+                auto& slot = slots_[(hint + i) % slot_count].epoch;
+                auto expected = idle;
+                if (slot.load(std::memory_order_relaxed) == idle
+                    && slot.compare_exchange_strong(expected, epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst))
+                {
+                    hint = (hint + i) % slot_count;
+                    return guard(&slot);
+                }
+            }
+
+            // Every slot is pinned, which takes more concurrent readers than slots
+            std::this_thread::yield();
+        }
+    }
+
+    /** Hands memory over to the domain, which frees it once no reader can still be using it.
+        @note The memory must already be unreachable for readers which pin after this call.
+        @param[in] p Memory to free
+        @param[in] reclaim Function which frees p */
+    void retire(void* p, void (*reclaim)(void*))
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back(retired{ p, reclaim, epoch_.load(std::memory_order_seq_cst) });
+    }
+
+    /** Advances the epoch and frees all retired memory which no pinned reader can still reach.
+        @return Amount of retired blocks which are still waiting */
+    size_t collect()
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+
+        // Readers which pin from now on can't have seen anything retired so far
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+
+        auto oldest = idle;
+        for (auto& slot : slots_)
+        {
+            oldest = std::min(oldest, slot.epoch.load(std::memory_order_seq_cst));
+        }
+
+        auto keep = std::partition(retired_.begin(), retired_.end(), [oldest](const retired& r) { return r.epoch >= oldest; });
+        for (auto it = keep; it != retired_.end(); ++it)
+        {
+            it->reclaim(it->p);
+        }
+        retired_.resize(std::distance(retired_.begin(), keep));
+
+        return retired_.size();
+    }
+
+private:
+    struct retired
+    {
+        void* p;
+        void (*reclaim)(void*);
+        uint64_t epoch;
+    };
+
+    /** One reader slot per cache line, so pinning doesn't contend with other readers */
+    struct alignas(64) reader_slot
+    {
+        std::atomic<uint64_t> epoch;
+    };
+
+    std::atomic<uint64_t> epoch_;
+    reader_slot slots_[slot_count];
+
+    std::mutex retired_mutex_;
+    custom_vector<retired> retired_;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <utility>
+
+#include "custom_vector.h"
+#include "epoch_domain.h"
+
+/** An append-only vector which readers may iterate without locks while a single writer appends.
+    When the writer outgrows the buffer it copies the objects into a larger one and retires the old buffer to an
+    epoch_domain instead of deleting it, so readers which are still iterating the old buffer stay valid. */
+template <typename T>
+class epoch_vector
+{
+public:
+    /** A pinned view over the objects published when it was taken */
+    class view
+    {
+    public:
+        /** See return
+            @return Amount of objects in the view */
+        size_t size() const noexcept
+        {
+            return objects_.size();
+        }
+
+        /** Indexing operator
+            @param[in] index Offset into the view
+            @return The object at the index given */
+        const T& operator[] (size_t index) const noexcept
+        {
+            return objects_[index];
+        }
+
+        /** See return
+            @return Returns the constant iterator to the first object */
+        const T* begin() const noexcept
+        {
+            return objects_.data();
+        }
+
+        /** See return
+            @return Returns the constant iterator to 1 past the last object */
+        const T* end() const noexcept
+        {
+            return objects_.data() + objects_.size();
+        }
+
+    private:
+        friend class epoch_vector;
+
+        epoch_domain::guard guard_;
+        std::span<const T> objects_;
+
+        view(epoch_domain::guard&& guard, std::span<const T> objects) : guard_(std::move(guard)), objects_(objects) {}
+    };
+
+    /** Constructor
+        @param[in] domain Domain which old buffers are retired to */
+    explicit epoch_vector(epoch_domain& domain = epoch_domain::global()) : domain_(domain), data_(nullptr), size_(0) {}
+
+    epoch_vector(const epoch_vector&) = delete;
+    epoch_vector& operator=(const epoch_vector&) = delete;
+
+    /** Pins an epoch and takes a view of the objects published so far. Lock-free.
+        @note The view stays valid even if the writer grows the vector, until the view is destroyed.
+        @return The pinned view */
+    view read() const noexcept
+    {
+        auto guard = domain_.pin();
+
+        // The size is published after the buffer holding it, so loading it first means the buffer is large enough
+        auto size = size_.load(std::memory_order_acquire);
+        auto data = data_.load(std::memory_order_seq_cst);
+        return view(std::move(guard), std::span<const T>(data, size));
+    }
+
+    /** See return
+        @return Amount of objects published so far */
+    size_t size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    /** Adds an object and publishes it. Writer only.
+        @param[in] t Object to add */
+    void push_back(const T& t)
+    {
+        emplace_back(t);
+    }
+
+    /** Emplaces an object and publishes it. Writer only.
+        @param[in] args Arguments to construct the object with */
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (current_.size() == current_.capacity())
+        {
+            grow(std::max(current_.size() + 1, current_.capacity() + current_.capacity() / 2));
+        }
+
+        current_.emplace_back(std::forward<Args>(args)...);
+        size_.store(current_.size(), std::memory_order_release);
+    }
+
+    /** Increases capacity if the new capacity is greater than the current. Writer only.
+        @param[in] new_cap New capacity for the vector */
+    void reserve(size_t new_cap)
+    {
+        if (new_cap > current_.capacity())
+        {
+            grow(new_cap);
+        }
+    }
+
+private:
+    epoch_domain& domain_;
+    std::atomic<const T*> data_;
+    std::atomic<size_t> size_;
+    custom_vector<T> current_;
+
+    /** Copies the objects to a larger buffer, publishes it, and retires the old buffer.
+        Objects are copied rather than moved because readers may still be using the originals.
+        @param[in] new_cap The new capacity for the vector */
+    void grow(size_t new_cap)
+    {
+        custom_vector<T> next;
+        next.reserve(new_cap);
+        next.append_range(current_);
+        current_.swap(next);
+        data_.store(current_.data(), std::memory_order_seq_cst);
+
+        if (next.capacity() > 0)
+        {
+            domain_.retire(new custom_vector<T>(std::move(next)), [](void* p) { delete static_cast<custom_vector<T>*>(p); });
+        }
+        domain_.collect();
+    }
+};
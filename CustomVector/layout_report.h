@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/** Where the bytes of a type go, worked out at compile time */
+struct layout_report
+{
+    size_t size;            ///< sizeof the type
+    size_t alignment;       ///< alignof the type
+    size_t members;         ///< Amount of members
+    size_t member_bytes;    ///< Sum of the sizes of the members
+    size_t padding;         ///< Bytes holding no member, size - member_bytes
+    size_t reordered_size;  ///< Size the type would have with its members ordered by decreasing alignment
+};
+
+namespace layout_detail
+{
+    /** Largest amount of members aggregate reflection handles */
+    constexpr size_t max_members = 12;
+
+    /** Converts to anything, to count how many initializers an aggregate accepts. Only used unevaluated. */
+    struct any_member
+    {
+        template <typename U>
+        operator U() const noexcept;
+    };
+
+    /** A list of types which is never instantiated with objects, so member arrays are fine in it */
+    template <typename... M>
+    struct type_list {};
+
+    /** Size and alignment of one member */
+    struct member_info
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+    /** See return
+        @return True if T can be initialized with one braced initializer per index. The braces stop a member array
+                from taking several initializers, which would otherwise make it count as several members. */
+    template <typename T, size_t... I>
+    constexpr bool initializable_with(std::index_sequence<I...>) noexcept
+    {
+        return requires { T{ { (void(I), any_member{}) }... }; };
+    }
+
+    /** See return
+        @return Amount of members of the aggregate T */
+    template <typename T, size_t N = 0>
+    constexpr size_t member_count() noexcept
+    {
+        if constexpr (N < max_members && initializable_with<T>(std::make_index_sequence<N + 1>{}))
+        {
+            return member_count<T, N + 1>();
+        }
+        else
+        {
+            return N;
+        }
+    }
+
+    /** Names the member types of an aggregate through a structured binding. Only used unevaluated, for its return type.
+        @param[in] t Object to bind to
+        @return A type_list of the member types */
+    template <typename T>
+    auto member_types(T& t)
+    {
+        constexpr auto count = member_count<T>();
+        static_assert(count > 0 && count <= max_members, "Aggregate has no members, or more than reflection handles");
+
+        if constexpr (count == 1)
+        {
+            auto& [m0] = t;
+            return type_list<decltype(m0)>{};
+        }
+        else if constexpr (count == 2)
+        {
+            auto& [m0, m1] = t;
+            return type_list<decltype(m0), decltype(m1)>{};
+        }
+        else if constexpr (count == 3)
+        {
+            auto& [m0, m1, m2] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2)>{};
+        }
+        else if constexpr (count == 4)
+        {
+            auto& [m0, m1, m2, m3] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3)>{};
+        }
+        else if constexpr (count == 5)
+        {
+            auto& [m0, m1, m2, m3, m4] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4)>{};
+        }
+        else if constexpr (count == 6)
+        {
+            auto& [m0, m1, m2, m3, m4, m5] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5)>{};
+        }
+        else if constexpr (count == 7)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6)>{};
+        }
+        else if constexpr (count == 8)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6), decltype(m7)>{};
+        }
+        else if constexpr (count == 9)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6), decltype(m7), decltype(m8)>{};
+        }
+        else if constexpr (count == 10)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6), decltype(m7), decltype(m8), decltype(m9)>{};
+        }
+        else if constexpr (count == 11)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6), decltype(m7), decltype(m8), decltype(m9), decltype(m10)>{};
+        }
+        else if constexpr (count == 12)
+        {
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11] = t;
+            return type_list<decltype(m0), decltype(m1), decltype(m2), decltype(m3), decltype(m4), decltype(m5), decltype(m6), decltype(m7), decltype(m8), decltype(m9), decltype(m10), decltype(m11)>{};
+        }
+    }
+
+    /** See return
+        @return Size and alignment of every type in the list */
+    template <typename... M>
+    constexpr auto infos(type_list<M...>) noexcept
+    {
+        return std::array<member_info, sizeof...(M)>{ member_info{ sizeof(M), alignof(M) }... };
+    }
+
+    /** Builds the report for a type from its members
+        @param[in] members Size and alignment of every member
+        @return The report */
+    template <typename T, size_t N>
+    constexpr layout_report make_report(std::array<member_info, N> members) noexcept
+    {
+        size_t member_bytes = 0;
+        for (auto& m : members)
+        {
+            member_bytes += m.size;
+        }
+
+        // Decreasing alignment leaves no gaps between members, as every size is a multiple of its alignment
+        std::sort(members.begin(), members.end(), [](const member_info& lhs, const member_info& rhs) { return lhs.alignment > rhs.alignment; });
+        size_t offset = 0;
+        for (auto& m : members)
+        {
+            offset = (offset + m.alignment - 1) / m.alignment * m.alignment + m.size;
+        }
+        auto reordered = (offset + alignof(T) - 1) / alignof(T) * alignof(T);
+
+        return layout_report{ sizeof(T), alignof(T), N, member_bytes, sizeof(T) - member_bytes, std::max(reordered, alignof(T)) };
+    }
+
+    /** Splits a pointer to member type into its class and member types */
+    template <typename P>
+    struct member_pointer;
+
+    template <typename C, typename M>
+    struct member_pointer<M C::*>
+    {
+        using class_type = C;
+        using member_type = M;
+    };
+}
+
+/** Reports the layout of an aggregate without listing its members, by counting and binding them.
+    @note Handles aggregates of up to 12 public members and without base classes
+    @return The layout of T */
+template <typename T>
+constexpr layout_report layout_of() noexcept requires std::is_aggregate_v<T>
+{
+    using members = decltype(layout_detail::member_types(std::declval<T&>()));
+    return layout_detail::make_report<T>(layout_detail::infos(members{}));
+}
+
+/** Reports the layout of a type from pointers to all of its members, for types which aren't aggregates
+    @return The layout of the class the members belong to */
+template <auto First, auto... Rest>
+constexpr layout_report layout_of_members() noexcept
+{
+    using T = typename layout_detail::member_pointer<decltype(First)>::class_type;
+    return layout_detail::make_report<T>(layout_detail::infos(layout_detail::type_list<
+        typename layout_detail::member_pointer<decltype(First)>::member_type,
+        typename layout_detail::member_pointer<decltype(Rest)>::member_type...>{}));
+}
@@ -9,4 +9,32 @@ int main()
     std::cout << test_index_loops() << '\n';
     std::cout << test_emplacement() << '\n';
     std::cout << test_weird_alignment() << '\n';
+    std::cout << test_spans() << '\n';
+    std::cout << test_from_range() << '\n';
+    std::cout << test_adopt_release() << '\n';
+#if defined(__unix__) || defined(__APPLE__)
+    std::cout << test_shared_vector() << '\n';
+#endif
+    std::cout << test_read_mostly_vector() << '\n';
+    std::cout << test_epoch_vector() << '\n';
+    std::cout << test_concurrent_fill() << '\n';
+    std::cout << test_combinable_vector() << '\n';
+#if defined(__unix__) || defined(__APPLE__)
+    std::cout << test_prefault() << '\n';
+#endif
+    std::cout << test_numa_fill() << '\n';
+    std::cout << test_copy_reuse() << '\n';
+    std::cout << test_fallible_growth() << '\n';
+    std::cout << test_constexpr() << '\n';
+    std::cout << test_bit_vector() << '\n';
+    std::cout << test_nullable_vector() << '\n';
+    std::cout << test_dict_vector() << '\n';
+    std::cout << test_string_vector() << '\n';
+    std::cout << test_rle_vector() << '\n';
+    std::cout << test_delta_vector() << '\n';
+    std::cout << test_poly_vector() << '\n';
+    std::cout << test_aosoa_vector() << '\n';
+    std::cout << test_layout() << '\n';
+    std::cout << test_slot_map() << '\n';
+    std::cout << test_sparse_set() << '\n';
 }
\ No newline at end of file
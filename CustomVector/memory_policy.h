@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+/** Where the pages of a buffer are placed on machines with several NUMA nodes */
+enum class numa_policy
+{
+    none,           ///< Leave placement to the operating system
+    local,          ///< Place each page on the node of the thread which first touches it
+    interleaved,    ///< Spread pages round-robin over every node
+    partitioned,    ///< Split the buffer into one range per hardware thread and place each range on that thread's node
+};
+
+/** Options applied to every buffer a vector allocates */
+struct memory_options
+{
+    bool prefault = false;              ///< Touch every page of new buffers up front, so the first writes don't page fault
+    bool lock = false;                  ///< Lock new buffers into RAM, so they are never paged out
+    numa_policy numa = numa_policy::none;  ///< Where pages of new buffers are placed. Also makes large fills construct in parallel.
+};
+
+namespace memory_policy
+{
+    /** Buffers at least this large are prefaulted by several threads */
+    constexpr size_t parallel_prefault_bytes = size_t(64) << 20;
+
+    /** Fills at least this large are constructed by several threads when a NUMA policy is set */
+    constexpr size_t parallel_first_touch_bytes = size_t(4) << 20;
+
+    /** See return
+        @return Size of a virtual memory page */
+    inline size_t page_size() noexcept
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        static const size_t size = size_t(::sysconf(_SC_PAGESIZE));
+        return size;
+#endif
+    }
+
+    /** See return
+        @return Amount of partitions large buffers and fills are split into, one per hardware thread */
+    inline size_t partition_count() noexcept
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /** See return
+        @param[in] count Amount of items being partitioned
+        @param[in] parts Amount of partitions
+        @param[in] i Index of the partition
+        @return Index of the first item in partition i. Partition i ends where partition i + 1 begins. */
+    constexpr size_t partition_begin(size_t count, size_t parts, size_t i) noexcept
+    {
+        return count / parts * i + std::min(i, count % parts);
+    }
+
+#if defined(__linux__)
+    /** Calls f(n) for every number in a file listing ranges of numbers, e.g. "0-1" or "0,2-3", as sysfs does for
+        nodes and CPUs
+        @param[in] path Path of the file
+        @param[in] f Callable which receives each number */
+    template <typename F>
+    void for_each_listed(const char* path, F f) noexcept
+    {
+        auto file = std::fopen(path, "r");
+        if (!file)
+        {
+            return;
+        }
+
+        unsigned first, last;
+        while (std::fscanf(file, "%u", &first) == 1)
+        {
+            if (std::fscanf(file, "-%u", &last) != 1)
+            {
+                last = first;
+            }
+            for (auto n = first; n <= last; ++n)
+            {
+                f(n);
+            }
+            if (std::fgetc(file) != ',')
+            {
+                break;
+            }
+        }
+        std::fclose(file);
+    }
+#endif
+
+    /** See return
+        @return Amount of NUMA nodes the machine has. 1 where this can't be determined. */
+    inline size_t numa_node_count() noexcept
+    {
+#if defined(__linux__)
+        static const size_t count = []
+        {
+            size_t nodes = 0;
+            for_each_listed("/sys/devices/system/node/online", [&nodes](unsigned) { ++nodes; });
+            return std::max<size_t>(nodes, 1);
+        }();
+        return count;
+#else
+        return 1;
+#endif
+    }
+
+    /** See return
+        @param[in] i Index of the partition
+        @param[in] parts Amount of partitions
+        @return Node which partition i is placed on. Consecutive partitions share a node, matching how hardware
+                threads are usually numbered per socket. */
+    inline size_t partition_node(size_t i, size_t parts) noexcept
+    {
+        return i * std::min<size_t>(numa_node_count(), 64) / parts;
+    }
+
+    /** Restricts the calling thread to the CPUs of a NUMA node, so memory it first touches is placed on that node.
+        Does nothing where the node's CPUs can't be determined.
+        @param[in] node Index of the node */
+    inline void pin_to_node(size_t node) noexcept
+    {
+#if defined(__linux__)
+        char path[64];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for_each_listed(path, [&cpus](unsigned cpu)
+        {
+            if (cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        });
+        if (CPU_COUNT(&cpus) > 0)
+        {
+            ::sched_setaffinity(0, sizeof(cpus), &cpus);
+        }
+#else
+        (void)node;
+#endif
+    }
+
+    /** Starts a thread, reporting failure instead of throwing it
+        @param[out] worker Thread to start
+        @param[in] f Callable for the thread to run
+        @return False if the thread couldn't be started */
+    template <typename F>
+    bool try_start(std::jthread& worker, F&& f) noexcept
+    {
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+        worker = std::jthread(std::forward<F>(f));
+        return true;
+#else
+        try
+        {
+            worker = std::jthread(std::forward<F>(f));
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+#endif
+    }
+
+    /** Calls f(first, last) for every partition of [0, count), each on its own thread. On machines with several NUMA
+        nodes each thread is pinned to its partition's node, so partitions of a buffer's bytes are first touched on the
+        node numa_bind() places them on. Partitions whose thread can't be started are handled by the calling thread
+        instead, so this never fails part way.
+        @note f is called concurrently and must not throw
+        @param[in] count Amount of items to partition
+        @param[in] f Callable which handles the half open range of items [first, last) */
+    template <typename F>
+    void for_each_partition(size_t count, F f) noexcept
+    {
+        auto parts = std::min(partition_count(), std::max<size_t>(count, 1));
+        auto run = [&f, count, parts](size_t i)
+        {
+            f(partition_begin(count, parts, i), partition_begin(count, parts, i + 1));
+        };
+
+        // With several nodes every partition gets a worker pinned to its node, leaving the caller's affinity alone.
+        // Otherwise the caller handles the first partition itself.
+        auto pin = numa_node_count() > 1;
+        size_t started = pin ? 0 : 1;
+        auto first_worker = started;
+
+        // Workers join when they go out of scope, whichever way that happens
+        std::unique_ptr<std::jthread[]> workers(new (std::nothrow) std::jthread[parts]);
+        while (workers && started < parts && try_start(workers[started], [&run, pin, parts, i = started]
+        {
+            if (pin)
+            {
+                pin_to_node(partition_node(i, parts));
+            }
+            run(i);
+        }))
+        {
+            ++started;
+        }
+
+        if (first_worker == 1)
+        {
+            run(0);
+        }
+        for (auto i = started; i < parts; ++i)
+        {
+            run(i);
+        }
+    }
+
+    /** Writes one byte per page so the operating system maps every page now rather than on first use.
+        @note The bytes are left zero, so only use this on memory which holds no objects yet.
+        @param[in] p First byte of the memory
+        @param[in] bytes Size of the memory */
+    inline void prefault(void* p, size_t bytes) noexcept
+    {
+        auto page = page_size();
+        auto first = static_cast<volatile char*>(p);
+
+        auto touch = [first, page](size_t from, size_t to)
+        {
+            for (auto offset = from; offset < to; offset += page)
+            {
+                first[offset] = 0;
+            }
+
+            // The memory needn't start on a page boundary, so the last page may not have been reached
+            if (from < to)
+            {
+                first[to - 1] = 0;
+            }
+        };
+
+        if (bytes < parallel_prefault_bytes || partition_count() == 1)
+        {
+            touch(0, bytes);
+            return;
+        }
+
+        // Split on page boundaries so every page is touched exactly once
+        auto pages = (bytes + page - 1) / page;
+        for_each_partition(pages, [&touch, page, bytes](size_t from, size_t to)
+        {
+            touch(from * page, std::min(bytes, to * page));
+        });
+    }
+
+    /** Locks memory into RAM. Works on whole pages, so neighbouring memory on the same pages is locked too.
+        @param[in] p First byte of the memory
+        @param[in] bytes Size of the memory
+        @return True if the memory was locked. Fails when the process exceeds its locked memory limit. */
+    inline bool lock(void* p, size_t bytes) noexcept
+    {
+#if defined(_WIN32)
+        return VirtualLock(p, bytes) != 0;
+#else
+        return ::mlock(p, bytes) == 0;
+#endif
+    }
+
+    /** Unlocks memory previously locked with lock()
+        @param[in] p First byte of the memory
+        @param[in] bytes Size of the memory */
+    inline void unlock(void* p, size_t bytes) noexcept
+    {
+#if defined(_WIN32)
+        VirtualUnlock(p, bytes);
+#else
+        ::munlock(p, bytes);
+#endif
+    }
+
+    /** Sets the NUMA policy of the whole pages within a range of memory. Pages which haven't been touched yet are
+        placed according to it. Does nothing on single node machines and on platforms without mbind.
+        @param[in] p First byte of the memory
+        @param[in] bytes Size of the memory
+        @param[in] policy Where to place the pages */
+    inline void numa_bind(void* p, size_t bytes, numa_policy policy) noexcept
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        auto nodes = std::min<size_t>(numa_node_count(), 64);
+        if (policy == numa_policy::none || nodes < 2)
+        {
+            return;
+        }
+
+        constexpr int mpol_preferred = 1;
+        constexpr int mpol_interleave = 3;
+        constexpr int mpol_local = 4;
+
+        // mbind only accepts whole pages
+        auto mbind = [](uintptr_t first, uintptr_t last, int mode, uint64_t mask)
+        {
+            auto page = page_size();
+            first = (first + page - 1) / page * page;
+            last = last / page * page;
+            if (first < last)
+            {
+                ::syscall(SYS_mbind, first, last - first, mode, mode == mpol_local ? nullptr : &mask, mode == mpol_local ? 0 : 65, 0);
+            }
+        };
+
+        auto first = reinterpret_cast<uintptr_t>(p);
+        switch (policy)
+        {
+        case numa_policy::local:
+            mbind(first, first + bytes, mpol_local, 0);
+            break;
+        case numa_policy::interleaved:
+            mbind(first, first + bytes, mpol_interleave, nodes == 64 ? ~uint64_t(0) : (uint64_t(1) << nodes) - 1);
+            break;
+        case numa_policy::partitioned:
+        {
+            auto parts = partition_count();
+            for (size_t i = 0; i < parts; ++i)
+            {
+                auto node = partition_node(i, parts);
+                mbind(first + partition_begin(bytes, parts, i), first + partition_begin(bytes, parts, i + 1), mpol_preferred, uint64_t(1) << node);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+#else
+        (void)p;
+        (void)bytes;
+        (void)policy;
+#endif
+    }
+
+    /** Applies options to a freshly allocated buffer. Never fails part way: options which can't be applied, such as a
+        lock over the limit or a prefault thread which can't start, are skipped or done by the calling thread.
+        @param[in] p First byte of the buffer
+        @param[in] bytes Size of the buffer
+        @param[in] options Options to apply
+        @return True if the buffer ended up locked and must be unlocked before it is freed */
+    inline bool apply(void* p, size_t bytes, const memory_options& options) noexcept
+    {
+        if (!p || bytes == 0)
+        {
+            return false;
+        }
+
+        // Placement must be decided before anything faults the pages in
+        numa_bind(p, bytes, options.numa);
+
+        // Locking faults every page in by itself, so prefaulting only matters when not locking
+        if (options.lock && lock(p, bytes))
+        {
+            return true;
+        }
+        if (options.prefault)
+        {
+            prefault(p, bytes);
+        }
+        return false;
+    }
+}
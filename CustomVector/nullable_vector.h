@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include "bit_vector.h"
+#include "custom_vector.h"
+
+/** A vector of optional values stored as two columns: the values themselves, contiguous and without the padding
+    std::optional adds, and a bitmap with one validity bit per value. Null positions hold a value initialized T.
+
+    The aggregates read the bitmap a word at a time, skip words with no valid values, and select between each value
+    and the identity of the operation without branching, so the inner loops vectorize. */
+template <typename T>
+class nullable_vector
+{
+public:
+    /** Default constructor */
+    nullable_vector() = default;
+
+    /** Adds a valid value to the end of the vector
+        @param[in] t Value to add */
+    void push_back(const T& t)
+    {
+        values_.push_back(t);
+        push_validity(true);
+    }
+
+    /** Adds a null to the end of the vector */
+    void push_back(std::nullopt_t)
+    {
+        values_.emplace_back();
+        push_validity(false);
+    }
+
+    /** Adds a value or a null to the end of the vector
+        @param[in] t Value to add, or nothing to add a null */
+    void push_back(const std::optional<T>& t)
+    {
+        if (t)
+        {
+            push_back(*t);
+        }
+        else
+        {
+            push_back(std::nullopt);
+        }
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The value at the index given, or nothing if it is null */
+    std::optional<T> operator[] (size_t index) const
+    {
+        if (!validity_[index])
+        {
+            return std::nullopt;
+        }
+        return values_[index];
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return True if the position holds a value rather than a null */
+    bool valid(size_t index) const noexcept
+    {
+        return validity_[index];
+    }
+
+    /** Increases capacity to hold at least count values
+        @param[in] count Amount of values the vector should have room for */
+    void reserve(size_t count)
+    {
+        values_.reserve(count);
+        validity_.reserve(count);
+    }
+
+    /** Removes every value and deallocates memory */
+    void clear() noexcept
+    {
+        values_.clear();
+        validity_.clear();
+    }
+
+    /** See return
+        @return Amount of values stored, including nulls */
+    size_t size() const noexcept
+    {
+        return values_.size();
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 value or null stored */
+    bool empty() const noexcept
+    {
+        return values_.empty();
+    }
+
+    /** See return
+        @return Amount of nulls stored, counted a bitmap word at a time */
+    size_t null_count() const noexcept
+    {
+        return size() - validity_.count();
+    }
+
+    /** See return
+        @return Every stored value, with value initialized objects in null positions */
+    std::span<const T> values() const noexcept
+    {
+        return std::span<const T>(values_.data(), values_.size());
+    }
+
+    /** See return
+        @return The validity bitmap, with a set bit for every position holding a value */
+    const bit_vector& validity() const noexcept
+    {
+        return validity_;
+    }
+
+    /** See return
+        @return Sum of the valid values, 0 if there are none */
+    T sum() const noexcept requires std::is_arithmetic_v<T>
+    {
+        return reduce(T(0), [](T a, T b) { return a + b; });
+    }
+
+    /** See return
+        @return Smallest valid value, or nothing if there are none */
+    std::optional<T> min() const noexcept requires std::is_arithmetic_v<T>
+    {
+        if (null_count() == size())
+        {
+            return std::nullopt;
+        }
+
+        constexpr auto identity = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+        return reduce(identity, [](T a, T b) { return b < a ? b : a; });
+    }
+
+    /** See return
+        @return Largest valid value, or nothing if there are none */
+    std::optional<T> max() const noexcept requires std::is_arithmetic_v<T>
+    {
+        if (null_count() == size())
+        {
+            return std::nullopt;
+        }
+
+        constexpr auto identity = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+        return reduce(identity, [](T a, T b) { return a < b ? b : a; });
+    }
+
+private:
+    custom_vector<T> values_;
+    bit_vector validity_;
+
+    /** Adds the validity bit of a value which was just added, removing the value again if that fails,
+        so the two columns always have the same length
+        @param[in] valid True if the value isn't null */
+    void push_validity(bool valid)
+    {
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+        validity_.push_back(valid);
+#else
+        try
+        {
+            validity_.push_back(valid);
+        }
+        catch (...)
+        {
+            values_.pop_back();
+            throw;
+        }
+#endif
+    }
+
+    /** Combines every valid value using the validity bitmap as a mask
+        @param[in] identity Value which leaves the result unchanged when combined, used in place of nulls
+        @param[in] f Associative operation combining two values
+        @return The combination of the identity and every valid value */
+    template <typename F>
+    T reduce(T identity, F f) const noexcept
+    {
+        constexpr size_t word_bits = 64;
+        auto words = validity_.words();
+
+        auto result = identity;
+        for (size_t w = 0; w < words.size(); ++w)
+        {
+            auto mask = words[w];
+            if (mask == 0)
+            {
+                continue;
+            }
+
+            auto first = values_.data() + w * word_bits;
+            auto count = std::min(word_bits, size() - w * word_bits);
+            auto partial = identity;
+            for (size_t i = 0; i < count; ++i)
+            {
+                partial = f(partial, ((mask >> i) & 1) ? first[i] : identity);
+            }
+            result = f(result, partial);
+        }
+        return result;
+    }
+};
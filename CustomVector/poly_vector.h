@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "custom_vector.h"
+#include "vector_core.h"
+
+/** A vector of objects of different types derived from Base, all stored inline in one byte buffer rather than each
+    behind its own pointer. Iterating visits the objects in memory order, so virtual calls on them don't add a cache
+    miss per object. Each object is placed at the next offset suitable for its alignment and an offset table records
+    where it went. Growing moves every object into the new buffer through a relocation function for its type.
+
+    Derived types must be nothrow move constructible, so growing can never fail halfway through. */
+template <typename Base>
+class poly_vector
+{
+    /** Functions for one derived type, shared by every object of that type */
+    struct type_ops
+    {
+        void (*relocate)(std::byte* from, std::byte* to) noexcept;  ///< Move constructs at to, then destroys at from
+        void (*destroy)(std::byte* p) noexcept;                     ///< Destroys the object at p
+    };
+
+    /** Where one object lives */
+    struct entry
+    {
+        size_t offset;          ///< Offset of the object in the buffer
+        size_t base;            ///< Offset of the object's Base subobject in the buffer
+        const type_ops* ops;    ///< Functions for the object's type
+    };
+
+    template <typename Derived>
+    static constexpr type_ops ops_for
+    {
+        [](std::byte* from, std::byte* to) noexcept
+        {
+            auto object = std::launder(reinterpret_cast<Derived*>(from));
+            ::new (static_cast<void*>(to)) Derived(std::move(*object));
+            object->~Derived();
+        },
+        [](std::byte* p) noexcept
+        {
+            std::launder(reinterpret_cast<Derived*>(p))->~Derived();
+        },
+    };
+
+public:
+    /** Iterator over the objects as Base */
+    template <bool Const>
+    class basic_iterator
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Base;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const Base&, Base&>;
+        using pointer = std::conditional_t<Const, const Base*, Base*>;
+
+        /** Default constructor */
+        basic_iterator() : entry_(nullptr), buffer_(nullptr) {}
+
+        /** See return
+            @return The object */
+        reference operator*() const noexcept
+        {
+            return *std::launder(reinterpret_cast<pointer>(buffer_ + entry_->base));
+        }
+
+        /** See return
+            @return Pointer to the object */
+        pointer operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        /** Moves to the next object
+            @return This iterator */
+        basic_iterator& operator++() noexcept
+        {
+            ++entry_;
+            return *this;
+        }
+
+        /** Moves to the next object
+            @return A copy of this iterator from before moving */
+        basic_iterator operator++(int) noexcept
+        {
+            auto old = *this;
+            ++entry_;
+            return old;
+        }
+
+        /** See return
+            @return True if both iterators are at the same object */
+        friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept
+        {
+            return lhs.entry_ == rhs.entry_;
+        }
+
+    private:
+        friend class poly_vector;
+
+        const entry* entry_;
+        std::byte* buffer_;
+
+        basic_iterator(const entry* e, std::byte* buffer) noexcept : entry_(e), buffer_(buffer) {}
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    /** Default constructor */
+    poly_vector() : buffer_(nullptr), used_(0), capacity_(0), align_(__STDCPP_DEFAULT_NEW_ALIGNMENT__) {}
+
+    poly_vector(const poly_vector&) = delete;
+    poly_vector& operator=(const poly_vector&) = delete;
+
+    /** Move constructor */
+    poly_vector(poly_vector&& a) noexcept : poly_vector()
+    {
+        swap(a);
+    }
+
+    /** Move assignment operator */
+    poly_vector& operator=(poly_vector&& a) noexcept
+    {
+        if (this != &a)
+        {
+            clear();
+            swap(a);
+        }
+        return *this;
+    }
+
+    /** Destructor */
+    ~poly_vector()
+    {
+        clear();
+    }
+
+    /** Swap function
+        @param[in, out] a Vector to swap with */
+    void swap(poly_vector& a) noexcept
+    {
+        using std::swap;
+        swap(entries_, a.entries_);
+        swap(buffer_, a.buffer_);
+        swap(used_, a.used_);
+        swap(capacity_, a.capacity_);
+        swap(align_, a.align_);
+    }
+
+    /** Constructs an object of a derived type at the end of the vector, growing the buffer as needed
+        @param[in] args Arguments for the constructor of Derived
+        @return The new object */
+    template <typename Derived, typename... Args>
+    Derived& emplace_back(Args&&... args)
+    {
+        static_assert(std::is_base_of_v<Base, Derived>, "Objects must derive from Base");
+        static_assert(std::is_nothrow_move_constructible_v<Derived>, "Objects are moved when the buffer grows");
+
+        auto offset = (used_ + alignof(Derived) - 1) / alignof(Derived) * alignof(Derived);
+        if (offset + sizeof(Derived) > capacity_ || alignof(Derived) > align_)
+        {
+            grow(offset + sizeof(Derived), std::max(align_, alignof(Derived)));
+        }
+
+        // The entry goes in first, so nothing needs undoing if adding it fails
+        entries_.push_back(entry{ offset, offset, &ops_for<Derived> });
+        Derived* object;
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+        object = ::new (static_cast<void*>(buffer_ + offset)) Derived(std::forward<Args>(args)...);
+#else
+        try
+        {
+            object = ::new (static_cast<void*>(buffer_ + offset)) Derived(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            entries_.pop_back();
+            throw;
+        }
+#endif
+
+        // Base needn't be the first subobject, e.g. with multiple inheritance
+        entries_[entries_.size() - 1].base = size_t(reinterpret_cast<std::byte*>(static_cast<Base*>(object)) - buffer_);
+        used_ = offset + sizeof(Derived);
+        return *object;
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The object at the index given */
+    Base& operator[] (size_t index) noexcept
+    {
+        return *std::launder(reinterpret_cast<Base*>(buffer_ + entries_[index].base));
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The constant object at the index given */
+    const Base& operator[] (size_t index) const noexcept
+    {
+        return *std::launder(reinterpret_cast<const Base*>(buffer_ + entries_[index].base));
+    }
+
+    /** Destructs all objects and deallocates memory */
+    void clear() noexcept
+    {
+        for (auto& e : entries_)
+        {
+            e.ops->destroy(buffer_ + e.offset);
+        }
+        entries_.clear();
+        vector_core::deallocate(buffer_, align_);
+        buffer_ = nullptr;
+        used_ = 0;
+        capacity_ = 0;
+        align_ = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    }
+
+    /** See return
+        @return Amount of objects stored */
+    size_t size() const noexcept
+    {
+        return entries_.size();
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 object stored */
+    bool empty() const noexcept
+    {
+        return entries_.empty();
+    }
+
+    /** See return
+        @return Bytes of the buffer occupied by objects and the padding between them */
+    size_t bytes_used() const noexcept
+    {
+        return used_;
+    }
+
+    /** See return
+        @return Returns the iterator to the first object in the vector */
+    iterator begin() noexcept
+    {
+        return iterator(entries_.data(), buffer_);
+    }
+
+    /** See return
+        @return Returns the iterator to 1 past the last object in the vector */
+    iterator end() noexcept
+    {
+        return iterator(entries_.data() + entries_.size(), buffer_);
+    }
+
+    /** See return
+        @return Returns the constant iterator to the first object in the vector */
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(entries_.data(), buffer_);
+    }
+
+    /** See return
+        @return Returns the constant iterator to 1 past the last object in the vector */
+    const_iterator end() const noexcept
+    {
+        return const_iterator(entries_.data() + entries_.size(), buffer_);
+    }
+
+private:
+    custom_vector<entry> entries_;
+    std::byte* buffer_;
+    size_t used_;
+    size_t capacity_;
+    size_t align_;
+
+    /** Moves every object into a larger buffer. Objects keep their offsets, which stay suitably aligned because the
+        new buffer is at least as aligned as the old one.
+        @param[in] min_bytes Size the new buffer needs at least
+        @param[in] align Alignment of the new buffer */
+    void grow(size_t min_bytes, size_t align)
+    {
+        auto new_capacity = std::max(min_bytes, capacity_ + capacity_ / 2);
+        auto buffer = static_cast<std::byte*>(vector_core::allocate(new_capacity, 1, align));
+        if (!buffer)
+        {
+#if defined(CUSTOM_VECTOR_NO_EXCEPTIONS)
+            std::abort();
+#else
+            throw std::bad_alloc();
+#endif
+        }
+
+        for (auto& e : entries_)
+        {
+            e.ops->relocate(buffer_ + e.offset, buffer + e.offset);
+        }
+
+        vector_core::deallocate(buffer_, align_);
+        buffer_ = buffer;
+        capacity_ = new_capacity;
+        align_ = align;
+    }
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+
+#include "custom_vector.h"
+#include "epoch_domain.h"
+
+/** A vector for data which is read far more often than it is written, such as configuration.
+    Readers never write to shared memory: they copy the contents and then check a sequence counter, retrying
+    if a writer was active in the meantime (a seqlock). Writers bump the counter to an odd value, make their
+    changes, and bump it back to even, so every batch of changes becomes visible to readers all at once.
+
+    Objects are stored as raw words which readers load and writers store through std::atomic_ref, so a reader
+    overlapping a writer sees torn data it then discards rather than a data race.
+
+    Buffers replaced by growth are retired to an epoch_domain instead of being freed, because a reader may still be
+    copying from them. Readers stay pinned while they copy, so a retired buffer is freed by a later write once every
+    reader which might have loaded it has finished. */
+template <typename T>
+class read_mostly_vector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Readers copy objects as raw bytes which may be torn and retried");
+
+    /** Unit objects are copied in: the widest unsigned type which evenly divides the size of T */
+    using word = std::conditional_t<sizeof(T) % 8 == 0, uint64_t,
+        std::conditional_t<sizeof(T) % 4 == 0, uint32_t,
+        std::conditional_t<sizeof(T) % 2 == 0, uint16_t, uint8_t>>>;
+
+    static constexpr size_t words_per_object = sizeof(T) / sizeof(word);
+
+    static_assert(alignof(word) >= std::atomic_ref<word>::required_alignment, "Words must be usable with std::atomic_ref");
+
+public:
+    /** Constructor
+        @param[in] domain Domain which old buffers are retired to */
+    explicit read_mostly_vector(epoch_domain& domain = epoch_domain::global()) :
+        domain_(domain), sequence_(0), data_(nullptr), size_(0), count_(0), pending_(0) {}
+
+    read_mostly_vector(const read_mostly_vector&) = delete;
+    read_mostly_vector& operator=(const read_mostly_vector&) = delete;
+
+    /** Copies a consistent snapshot of every object into out, reusing its memory where possible. Lock-free.
+        @param[out] out Vector which receives the snapshot */
+    void snapshot(custom_vector<T>& out) const
+    {
+        auto guard = domain_.pin();
+        for (;;)
+        {
+            auto seq = sequence_.load(std::memory_order_acquire);
+            if (seq & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The size is published after the buffer holding it, so loading it first means the buffer is large enough.
+            // Acquiring the buffer makes its initialization visible even when it is newer than the size, and
+            // sequential consistency orders the load after pinning, as the epoch domain requires.
+            auto size = size_.load(std::memory_order_acquire);
+            auto data = data_.load(std::memory_order_seq_cst);
+            out.resize(size);
+            load_words(reinterpret_cast<unsigned char*>(out.data()), data, size * words_per_object);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == seq)
+            {
+                return;
+            }
+        }
+    }
+
+    /** See return
+        @return A consistent snapshot of every object */
+    custom_vector<T> snapshot() const
+    {
+        custom_vector<T> out;
+        snapshot(out);
+        return out;
+    }
+
+    /** Reads a single object consistently. Lock-free.
+        @param[in] index Offset into the vector
+        @return The object at the index given, or nothing if the index is out of range */
+    std::optional<T> get(size_t index) const
+    {
+        auto guard = domain_.pin();
+        for (;;)
+        {
+            auto seq = sequence_.load(std::memory_order_acquire);
+            if (seq & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            bool in_range = index < size_.load(std::memory_order_acquire);
+            std::array<unsigned char, sizeof(T)> bytes;
+            if (in_range)
+            {
+                load_words(bytes.data(), data_.load(std::memory_order_seq_cst) + index * words_per_object, words_per_object);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == seq)
+            {
+                if (!in_range)
+                {
+                    return std::nullopt;
+                }
+                return std::bit_cast<T>(bytes);
+            }
+        }
+    }
+
+    /** See return
+        @return Amount of objects most recently published */
+    size_t size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    /** Replaces every object, publishing the new contents all at once.
+        @param[in] objects New contents of the vector */
+    void assign(std::span<const T> objects)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collect_retired();
+        grow_if_required(objects.size());
+
+        write_section section(*this);
+        store_objects(0, objects.data(), objects.size());
+        count_ = objects.size();
+    }
+
+    /** Adds an object and publishes it.
+        @param[in] t Object to add */
+    void push_back(const T& t)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collect_retired();
+        grow_if_required(count_ + 1);
+
+        write_section section(*this);
+        store_objects(count_, &t, 1);
+        ++count_;
+    }
+
+    /** Replaces an object and publishes it.
+        @param[in] index Offset into the vector
+        @param[in] t New value of the object */
+    void set(size_t index, const T& t)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collect_retired();
+
+        write_section section(*this);
+        store_objects(index, &t, 1);
+    }
+
+    /** Applies a batch of in place changes which readers will see all at once.
+        f works on a private copy of the objects, which is then published as a whole.
+        @note If f throws, none of its changes are published and the exception propagates.
+        @param[in] f Callable which receives a span over every object. It must not keep the span. */
+    template <typename F>
+    void modify(F&& f)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collect_retired();
+
+        // Only writers store to the buffer and they hold the lock, so reading it here can't race
+        scratch_.resize(0);
+        scratch_.reserve(count_);
+        for (size_t i = 0; i < count_; ++i)
+        {
+            std::array<unsigned char, sizeof(T)> bytes;
+            std::memcpy(bytes.data(), current_.data() + i * words_per_object, sizeof(T));
+            scratch_.push_back(std::bit_cast<T>(bytes));
+        }
+        f(std::span<T>(scratch_.data(), scratch_.size()));
+
+        write_section section(*this);
+        store_objects(0, scratch_.data(), count_);
+    }
+
+private:
+    /** Keeps the sequence counter odd for its lifetime, so readers can't be left spinning by an exception */
+    class write_section
+    {
+    public:
+        explicit write_section(read_mostly_vector& v) noexcept : v_(v)
+        {
+            v_.begin_write();
+        }
+
+        ~write_section()
+        {
+            v_.end_write();
+        }
+
+        write_section(const write_section&) = delete;
+        write_section& operator=(const write_section&) = delete;
+
+    private:
+        read_mostly_vector& v_;
+    };
+
+    epoch_domain& domain_;
+    std::atomic<size_t> sequence_;
+    std::atomic<const word*> data_;
+    std::atomic<size_t> size_;
+
+    std::mutex writer_mutex_;
+    custom_vector<word> current_;           ///< Words of every object the buffer has room for, published or not
+    size_t count_;                          ///< Amount of objects the writer has stored
+    custom_vector<T> scratch_;              ///< Private copy which modify() changes
+    size_t pending_;                        ///< Retired buffers the domain still held after the last collection
+
+    /** Copies words which a writer may be storing at the same time. The result may be torn, never undefined.
+        @param[out] out First byte to copy to
+        @param[in] words First word to copy
+        @param[in] count Amount of words to copy */
+    static void load_words(unsigned char* out, const word* words, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            // The words are never const, only viewed as const by readers
+            auto w = std::atomic_ref<word>(const_cast<word&>(words[i])).load(std::memory_order_relaxed);
+            std::memcpy(out + i * sizeof(word), &w, sizeof(word));
+        }
+    }
+
+    /** Stores objects into the buffer, which readers may be loading at the same time
+        @param[in] index Offset of the first object to store
+        @param[in] objects Objects to store
+        @param[in] count Amount of objects to store */
+    void store_objects(size_t index, const T* objects, size_t count) noexcept
+    {
+        auto bytes = reinterpret_cast<const unsigned char*>(objects);
+        auto words = current_.data() + index * words_per_object;
+        for (size_t i = 0; i < count * words_per_object; ++i)
+        {
+            word w;
+            std::memcpy(&w, bytes + i * sizeof(word), sizeof(word));
+            std::atomic_ref<word>(words[i]).store(w, std::memory_order_relaxed);
+        }
+    }
+
+    /** Moves to a larger buffer ahead of a write section, so readers never copy from freed memory.
+        @param[in] required Amount of objects the buffer must be able to hold */
+    void grow_if_required(size_t required)
+    {
+        auto capacity = current_.size() / words_per_object;
+        if (required <= capacity)
+        {
+            return;
+        }
+
+        // Readers can't see the new buffer until it is published, so filling it needs no atomics
+        custom_vector<word> next;
+        next.resize(std::max(required, capacity + capacity / 2) * words_per_object);
+        std::copy(current_.begin(), current_.begin() + count_ * words_per_object, next.begin());
+
+        {
+            write_section section(*this);
+            current_.swap(next);
+        }
+
+        if (next.capacity() > 0)
+        {
+            domain_.retire(new custom_vector<word>(std::move(next)), [](void* p) { delete static_cast<custom_vector<word>*>(p); });
+        }
+        pending_ = domain_.collect();
+    }
+
+    /** Frees retired buffers which readers have finished with, while any are still waiting */
+    void collect_retired()
+    {
+        if (pending_ > 0)
+        {
+            pending_ = domain_.collect();
+        }
+    }
+
+    /** Marks the start of a batch of changes. Readers which overlap it will retry. */
+    void begin_write() noexcept
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /** Publishes a batch of changes */
+    void end_write() noexcept
+    {
+        data_.store(current_.data(), std::memory_order_seq_cst);
+        size_.store(count_, std::memory_order_release);
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
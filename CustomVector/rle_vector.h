@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <ranges>
+
+#include "custom_vector.h"
+
+/** A vector for sequences made of long runs of equal values. Each run is stored once as its value plus the index
+    1 past its last position, so memory grows with the amount of runs rather than the amount of values.
+    Random access binary searches the run ends, while scanning run by run costs one step per run. */
+template <typename T>
+class rle_vector
+{
+public:
+    /** Default constructor */
+    rle_vector() = default;
+
+    /** Encodes a range of values
+        @param[in] r Range of values to encode
+        @return A vector holding the same sequence of values */
+    template <std::ranges::input_range R>
+    static rle_vector from_range(R&& r)
+    {
+        rle_vector vec;
+        for (auto&& t : r)
+        {
+            vec.push_back(t);
+        }
+        return vec;
+    }
+
+    /** Adds a value to the end of the vector, extending the last run if it holds the same value
+        @param[in] t Value to add */
+    void push_back(const T& t)
+    {
+        push_back(t, 1);
+    }
+
+    /** Adds count copies of a value to the end of the vector, extending the last run if it holds the same value
+        @param[in] t Value to add
+        @param[in] count Amount of copies to add */
+    void push_back(const T& t, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (!values_.empty() && values_[values_.size() - 1] == t)
+        {
+            ends_[ends_.size() - 1] += count;
+            return;
+        }
+
+        values_.push_back(t);
+        ends_.push_back(size() + count);
+    }
+
+    /** Indexing operator. Logarithmic in the amount of runs.
+        @param[in] index Offset into the vector
+        @return The value at the index given */
+    const T& operator[] (size_t index) const noexcept
+    {
+        return values_[run_of(index)];
+    }
+
+    /** See return
+        @param[in] index Offset into the vector, less than size()
+        @return Index of the run holding the position */
+    size_t run_of(size_t index) const noexcept
+    {
+        return size_t(std::upper_bound(ends_.begin(), ends_.end(), index) - ends_.begin());
+    }
+
+    /** Calls f(value, count) for every run in order
+        @param[in] f Callable which receives the value of a run and how many positions it covers */
+    template <typename F>
+    void for_each_run(F f) const
+    {
+        size_t first = 0;
+        for (size_t i = 0; i < values_.size(); ++i)
+        {
+            f(values_[i], ends_[i] - first);
+            first = ends_[i];
+        }
+    }
+
+    /** Decodes every value into out, replacing its contents and reserving exactly once
+        @param[out] out Vector which receives the values */
+    void decode(custom_vector<T>& out) const
+    {
+        out.resize(0);
+        out.reserve(size());
+        for_each_run([&out](const T& t, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                out.push_back(t);
+            }
+        });
+    }
+
+    /** See return
+        @return A plain vector holding every value */
+    custom_vector<T> decode() const
+    {
+        custom_vector<T> out;
+        decode(out);
+        return out;
+    }
+
+    /** Removes every value and deallocates memory */
+    void clear() noexcept
+    {
+        values_.clear();
+        ends_.clear();
+    }
+
+    /** See return
+        @return Amount of values stored */
+    size_t size() const noexcept
+    {
+        return ends_.empty() ? 0 : ends_[ends_.size() - 1];
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 value stored */
+    bool empty() const noexcept
+    {
+        return ends_.empty();
+    }
+
+    /** See return
+        @return Amount of runs stored */
+    size_t run_count() const noexcept
+    {
+        return values_.size();
+    }
+
+private:
+    custom_vector<T> values_;       ///< Value of each run
+    custom_vector<size_t> ends_;    ///< Index 1 past the last position of each run
+};
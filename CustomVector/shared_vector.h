@@ -0,0 +1,423 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** A vector living in shared memory, so processes on the same host can read one copy of the data.
+    One process creates the segment and is the only writer. Any number of processes open it read-only.
+    Nothing inside the segment is a pointer: the header stores counts and the offset of the first object,
+    so every process may map the segment at a different address.
+
+    Growth protocol: the writer enlarges the segment, remaps its own view and only then publishes the new
+    capacity and size with release semantics. The segment never shrinks, so a reader's existing mapping stays
+    valid and refresh() only has to map a larger view once it sees a larger capacity. */
+template <typename T>
+class shared_vector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Objects in shared memory are copied between processes as raw bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Atomics in shared memory must not rely on a process local lock");
+
+public:
+    /** Creates a named segment and opens it for writing.
+        @note Throws std::system_error with EEXIST if a segment of that name exists, unless replace is set
+        @param[in] name Name of the segment, which should start with a '/'
+        @param[in] capacity Amount of objects to make room for up front
+        @param[in] replace Unlink an existing segment of the same name first. Only for stale segments: a writer still
+                           using the old segment keeps writing to it, while new readers open the new one.
+        @return The writer for the segment */
+    static shared_vector create(const std::string& name, size_t capacity, bool replace = false)
+    {
+        if (replace)
+        {
+            ::shm_unlink(name.c_str());
+        }
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+
+        return create_from_fd(fd, capacity);
+    }
+
+#if defined(__linux__)
+    /** Creates an anonymous segment, which other processes may open through an inherited or passed file descriptor.
+        @param[in] capacity Amount of objects to make room for up front
+        @return The writer for the segment */
+    static shared_vector create_anonymous(size_t capacity)
+    {
+        int fd = ::memfd_create("shared_vector", MFD_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "memfd_create");
+        }
+
+        return create_from_fd(fd, capacity);
+    }
+#endif
+
+    /** Opens an existing named segment for reading.
+        @param[in] name Name the segment was created with
+        @return A reader for the segment */
+    static shared_vector open(const std::string& name)
+    {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+
+        return open_from_fd(fd);
+    }
+
+    /** Opens a segment for reading from a file descriptor, such as the one returned by fd().
+        @param[in] fd Descriptor of the segment. It is duplicated, so the caller keeps ownership of it.
+        @return A reader for the segment */
+    static shared_vector attach(int fd)
+    {
+        int own_fd = ::dup(fd);
+        if (own_fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "dup");
+        }
+
+        return open_from_fd(own_fd);
+    }
+
+    /** Removes a named segment. Processes which already mapped it keep their mappings.
+        @param[in] name Name the segment was created with */
+    static void unlink(const std::string& name) noexcept
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    /** Move constructor */
+    shared_vector(shared_vector&& a) noexcept : shared_vector()
+    {
+        swap(a);
+    }
+
+    /** Move assignment operator */
+    shared_vector& operator=(shared_vector&& a) noexcept
+    {
+        shared_vector(std::move(a)).swap(*this);
+        return *this;
+    }
+
+    shared_vector(const shared_vector&) = delete;
+    shared_vector& operator=(const shared_vector&) = delete;
+
+    /** Destructor. Unmaps the segment but leaves it in place for other processes. */
+    ~shared_vector()
+    {
+        if (base_)
+        {
+            ::munmap(base_, mapped_bytes_);
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    /** Swap function
+        @param[in, out] a Vector to swap with */
+    void swap(shared_vector& a) noexcept
+    {
+        using std::swap;
+        swap(fd_, a.fd_);
+        swap(base_, a.base_);
+        swap(mapped_bytes_, a.mapped_bytes_);
+        swap(writer_, a.writer_);
+    }
+
+    /** Adds an object and publishes the new size. Writer only.
+        @param[in] t Object to add */
+    void push_back(const T& t)
+    {
+        append(std::span<const T>(&t, 1));
+    }
+
+    /** Adds several objects and publishes them to readers all at once. Writer only.
+        @param[in] objects Objects to add */
+    void append(std::span<const T> objects)
+    {
+        auto old_size = segment_header()->size.load(std::memory_order_relaxed);
+        auto new_size = old_size + objects.size();
+
+        if (new_size > capacity())
+        {
+            reserve(std::max<size_t>(new_size, capacity() + capacity() / 2));
+        }
+
+        if (!objects.empty())
+        {
+            std::memcpy(static_cast<void*>(writable_data() + old_size), objects.data(), objects.size_bytes());
+        }
+        segment_header()->size.store(new_size, std::memory_order_release);
+    }
+
+    /** Grows the segment so it can hold at least new_cap objects. Writer only.
+        @param[in] new_cap New capacity for the vector */
+    void reserve(size_t new_cap)
+    {
+        if (new_cap <= capacity())
+        {
+            return;
+        }
+
+        // The segment must be large enough before anyone is told about the new capacity
+        auto new_bytes = bytes_for(new_cap);
+        if (::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "ftruncate");
+        }
+
+        remap(new_bytes);
+        segment_header()->capacity.store(new_cap, std::memory_order_release);
+    }
+
+    /** Maps more of the segment if the writer has grown it since the last call.
+        @return The amount of objects which are safe to read */
+    size_t refresh()
+    {
+        auto published_cap = segment_header()->capacity.load(std::memory_order_acquire);
+        if (bytes_for(published_cap) > mapped_bytes_)
+        {
+            remap(bytes_for(published_cap));
+        }
+        return size();
+    }
+
+    /** See return
+        @note Never exceeds what this process has mapped, so every index below it may be read.
+        @return Amount of objects published by the writer */
+    size_t size() const noexcept
+    {
+        return std::min<size_t>(segment_header()->size.load(std::memory_order_acquire), mapped_capacity());
+    }
+
+    /** See return
+        @return Amount of objects the segment currently has room for */
+    size_t capacity() const noexcept
+    {
+        return segment_header()->capacity.load(std::memory_order_acquire);
+    }
+
+    /** See return
+        @return True if no objects have been published */
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /** See return
+        @return True if this process created the segment and may write to it */
+    bool writer() const noexcept
+    {
+        return writer_;
+    }
+
+    /** See return
+        @return The descriptor of the segment, for handing to other processes */
+    int fd() const noexcept
+    {
+        return fd_;
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return The object at the index given */
+    const T& operator[] (size_t index) const noexcept
+    {
+        return data()[index];
+    }
+
+    /** See return
+        @return Returns a pointer to the first object in this process's mapping */
+    const T* data() const noexcept
+    {
+        return std::launder(reinterpret_cast<const T*>(static_cast<const char*>(base_) + segment_header()->data_offset));
+    }
+
+    /** See return
+        @return Returns the constant iterator to the first object */
+    const T* begin() const noexcept
+    {
+        return data();
+    }
+
+    /** See return
+        @return Returns the constant iterator to 1 past the last published object */
+    const T* end() const noexcept
+    {
+        return data() + size();
+    }
+
+private:
+    /** Lives at offset 0 of the segment. Only counts and offsets, never pointers. */
+    struct header
+    {
+        std::atomic<uint64_t> magic;        ///< Written last, so a segment with a valid magic has a complete header
+        uint64_t object_size;
+        uint64_t data_offset;
+        std::atomic<uint64_t> capacity;
+        std::atomic<uint64_t> size;
+    };
+
+    static constexpr uint64_t magic_value = 0x5348564543544f52; // "SHVECTOR"
+
+    /** How long open() waits for a creator which hasn't finished writing the header */
+    static constexpr auto header_wait = std::chrono::milliseconds(100);
+
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    bool writer_ = false;
+
+    shared_vector() = default;
+
+    /** See return
+        @return Offset of the first object from the start of the segment */
+    static constexpr size_t data_offset() noexcept
+    {
+        constexpr size_t align = std::max<size_t>(alignof(T), 64);
+        return (sizeof(header) + align - 1) / align * align;
+    }
+
+    /** See return
+        @note Throws std::system_error with EOVERFLOW if the size can't be represented
+        @param[in] cap Capacity in objects
+        @return Size of a segment with room for cap objects */
+    static size_t bytes_for(size_t cap)
+    {
+        constexpr auto max_bytes = static_cast<size_t>(std::numeric_limits<off_t>::max());
+        if (cap > (max_bytes - data_offset()) / sizeof(T))
+        {
+            throw std::system_error(EOVERFLOW, std::generic_category(), "shared_vector capacity is too large");
+        }
+        return data_offset() + cap * sizeof(T);
+    }
+
+    static shared_vector create_from_fd(int fd, size_t capacity)
+    {
+        shared_vector vec;
+        vec.fd_ = fd;
+        vec.writer_ = true;
+
+        auto bytes = bytes_for(capacity);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "ftruncate");
+        }
+        vec.remap(bytes);
+
+        // A fresh segment is zero filled. The magic is published last, so readers never see a partial header.
+        auto h = vec.segment_header();
+        h->object_size = sizeof(T);
+        h->data_offset = data_offset();
+        h->size.store(0, std::memory_order_relaxed);
+        h->capacity.store(capacity, std::memory_order_relaxed);
+        h->magic.store(magic_value, std::memory_order_release);
+        return vec;
+    }
+
+    static shared_vector open_from_fd(int fd)
+    {
+        shared_vector vec;
+        vec.fd_ = fd;
+
+        // The creator may still be sizing the segment or writing its header, so give it a moment to finish
+        auto deadline = std::chrono::steady_clock::now() + header_wait;
+        for (;;)
+        {
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "fstat");
+            }
+            if (static_cast<size_t>(st.st_size) >= bytes_for(0))
+            {
+                vec.remap(static_cast<size_t>(st.st_size));
+                auto magic = vec.segment_header()->magic.load(std::memory_order_acquire);
+                if (magic == magic_value)
+                {
+                    break;
+                }
+                if (magic != 0)
+                {
+                    throw std::system_error(EINVAL, std::generic_category(), "shared_vector segment holds a different type");
+                }
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                throw std::system_error(EAGAIN, std::generic_category(), "shared_vector segment isn't initialized");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto h = vec.segment_header();
+        if (h->object_size != sizeof(T) || h->data_offset != data_offset())
+        {
+            throw std::system_error(EINVAL, std::generic_category(), "shared_vector segment holds a different type");
+        }
+        return vec;
+    }
+
+    /** Replaces this process's mapping with one covering the given amount of bytes
+        @param[in] bytes Size of the new mapping */
+    void remap(size_t bytes)
+    {
+        int prot = writer_ ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* p = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED)
+        {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+
+        if (base_)
+        {
+            ::munmap(base_, mapped_bytes_);
+        }
+        base_ = p;
+        mapped_bytes_ = bytes;
+    }
+
+    /** See return
+        @return Amount of objects covered by this process's mapping */
+    size_t mapped_capacity() const noexcept
+    {
+        return (mapped_bytes_ - data_offset()) / sizeof(T);
+    }
+
+    header* segment_header() const noexcept
+    {
+        return static_cast<header*>(base_);
+    }
+
+    T* writable_data() noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(static_cast<char*>(base_) + data_offset()));
+    }
+};
+
+#endif
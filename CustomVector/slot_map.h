@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "custom_vector.h"
+
+/** A container handing out handles which stay valid until their own object is erased, with objects kept densely
+    packed for iteration. Objects live in a plain vector; each handle names a slot which records where its object
+    currently is. Erasing moves the last object into the gap, updates that object's slot, and puts the erased slot
+    on a free list for reuse.
+
+    Slots carry a generation which is bumped whenever their object is erased, and handles remember the generation
+    they were issued with, so a handle to an erased object never finds the object which later reuses its slot. */
+template <typename T>
+class slot_map
+{
+public:
+    /** Names one object for as long as it lives */
+    struct handle
+    {
+        uint32_t slot;          ///< Slot which records where the object is
+        uint32_t generation;    ///< Generation of the slot when the handle was issued
+
+        /** See return
+            @return True if both handles name the same object */
+        friend bool operator==(const handle& lhs, const handle& rhs) noexcept = default;
+    };
+
+    using iterator = typename custom_vector<T>::iterator;
+    using const_iterator = typename custom_vector<T>::const_iterator;
+
+    /** Default constructor */
+    slot_map() : free_(no_slot) {}
+
+    /** Adds an object
+        @param[in] t Object to add
+        @return Handle to the new object */
+    handle insert(const T& t)
+    {
+        return emplace(t);
+    }
+
+    /** Constructs an object in place
+        @param[in] args Arguments for the constructor of T
+        @return Handle to the new object */
+    template <typename... Args>
+    handle emplace(Args&&... args)
+    {
+        // Nothing else changes until the object exists, so a throwing constructor leaves the map as it was
+        values_.emplace_back(std::forward<Args>(args)...);
+
+        uint32_t slot = free_;
+        if (slot == no_slot)
+        {
+            slot = uint32_t(slots_.size());
+            slots_.push_back(slot_entry{ 0, 0 });
+        }
+        else
+        {
+            free_ = slots_[slot].index;
+        }
+
+        slots_[slot].index = uint32_t(values_.size() - 1);
+        owners_.push_back(slot);
+        return handle{ slot, slots_[slot].generation };
+    }
+
+    /** Erases an object in constant time by moving the last object into its place
+        @param[in] h Handle to the object
+        @return False if the handle didn't name a live object */
+    bool erase(handle h)
+    {
+        if (!contains(h))
+        {
+            return false;
+        }
+
+        auto index = slots_[h.slot].index;
+        auto last = uint32_t(values_.size() - 1);
+        if (index != last)
+        {
+            values_[index] = std::move(values_[last]);
+            owners_[index] = owners_[last];
+            slots_[owners_[index]].index = index;
+        }
+        values_.pop_back();
+        owners_.pop_back();
+
+        ++slots_[h.slot].generation;
+        slots_[h.slot].index = free_;
+        free_ = h.slot;
+        return true;
+    }
+
+    /** See return
+        @param[in] h Handle to check
+        @return True if the handle names a live object */
+    bool contains(handle h) const noexcept
+    {
+        return h.slot < slots_.size() && slots_[h.slot].generation == h.generation;
+    }
+
+    /** Looks an object up by handle
+        @param[in] h Handle to the object
+        @return The object, or nullptr if the handle doesn't name a live object */
+    T* find(handle h) noexcept
+    {
+        return contains(h) ? &values_[slots_[h.slot].index] : nullptr;
+    }
+
+    /** Looks an object up by handle
+        @param[in] h Handle to the object
+        @return The constant object, or nullptr if the handle doesn't name a live object */
+    const T* find(handle h) const noexcept
+    {
+        return contains(h) ? &values_[slots_[h.slot].index] : nullptr;
+    }
+
+    /** See return
+        @param[in] index Offset into the packed objects
+        @return Handle to the object at the index given */
+    handle handle_at(size_t index) const noexcept
+    {
+        auto slot = owners_[index];
+        return handle{ slot, slots_[slot].generation };
+    }
+
+    /** Erases every object. Every handle issued so far stops naming an object. */
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < owners_.size(); ++i)
+        {
+            auto slot = owners_[i];
+            ++slots_[slot].generation;
+            slots_[slot].index = free_;
+            free_ = slot;
+        }
+        while (!values_.empty())
+        {
+            values_.pop_back();
+        }
+        owners_.resize(0);
+    }
+
+    /** Increases capacity to hold at least count objects without reallocating
+        @param[in] count Amount of objects the map should have room for */
+    void reserve(size_t count)
+    {
+        values_.reserve(count);
+        owners_.reserve(count);
+        slots_.reserve(count);
+    }
+
+    /** See return
+        @return Amount of live objects */
+    size_t size() const noexcept
+    {
+        return values_.size();
+    }
+
+    /** See return
+        @return True if the map currently has at least 1 live object */
+    bool empty() const noexcept
+    {
+        return values_.empty();
+    }
+
+    /** See return
+        @return Returns the iterator to the first packed object. Erasing reorders objects. */
+    iterator begin() noexcept
+    {
+        return values_.begin();
+    }
+
+    /** See return
+        @return Returns the iterator to 1 past the last packed object */
+    iterator end() noexcept
+    {
+        return values_.end();
+    }
+
+    /** See return
+        @return Returns the constant iterator to the first packed object. Erasing reorders objects. */
+    const_iterator begin() const noexcept
+    {
+        return values_.begin();
+    }
+
+    /** See return
+        @return Returns the constant iterator to 1 past the last packed object */
+    const_iterator end() const noexcept
+    {
+        return values_.end();
+    }
+
+private:
+    static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+    /** Where a slot's object is, or the next free slot while the slot is free */
+    struct slot_entry
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    custom_vector<T> values_;
+    custom_vector<uint32_t> owners_;        ///< Slot of each packed object, for updating it when the object moves
+    custom_vector<slot_entry> slots_;
+    uint32_t free_;                         ///< First free slot, or no_slot
+};
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "custom_vector.h"
+
+/** Component storage for entity ids: values are packed densely alongside the id each belongs to, and a sparse index
+    maps ids to positions in the packed arrays. Insert, erase and lookup are constant time and iterating touches only
+    packed memory.
+
+    The sparse index is split into pages which are only allocated once an id within them is used, so a few large ids
+    don't cost an index entry for every smaller id. Erasing moves the last value into the gap, so order isn't kept
+    unless restored with sort_as(). */
+template <typename T>
+class sparse_set
+{
+public:
+    /** Amount of ids covered by each page of the sparse index */
+    static constexpr size_t page_size = 4096;
+
+    using iterator = typename custom_vector<T>::iterator;
+    using const_iterator = typename custom_vector<T>::const_iterator;
+
+    /** Default constructor */
+    sparse_set() = default;
+
+    /** Adds a value for an id which doesn't have one yet
+        @param[in] id Entity id
+        @param[in] t Value to add
+        @return False, leaving the set unchanged, if the id already has a value */
+    bool insert(uint32_t id, const T& t)
+    {
+        if (contains(id))
+        {
+            return false;
+        }
+        emplace(id, t);
+        return true;
+    }
+
+    /** Constructs the value for an id in place, replacing any value the id already has
+        @param[in] id Entity id
+        @param[in] args Arguments for the constructor of T
+        @return The id's value */
+    template <typename... Args>
+    T& emplace(uint32_t id, Args&&... args)
+    {
+        if (auto existing = find(id))
+        {
+            *existing = T(std::forward<Args>(args)...);
+            return *existing;
+        }
+
+        auto& entry = sparse_entry(id);
+        values_.emplace_back(std::forward<Args>(args)...);
+        ids_.push_back(id);
+        entry = uint32_t(ids_.size());
+        return values_[values_.size() - 1];
+    }
+
+    /** Erases the value of an id in constant time by moving the last value into its place
+        @param[in] id Entity id
+        @return False if the id had no value */
+    bool erase(uint32_t id)
+    {
+        auto index = index_of(id);
+        if (index == npos)
+        {
+            return false;
+        }
+
+        auto last = ids_.size() - 1;
+        if (index != last)
+        {
+            values_[index] = std::move(values_[last]);
+            ids_[index] = ids_[last];
+            sparse_entry(ids_[index]) = uint32_t(index + 1);
+        }
+        values_.pop_back();
+        ids_.pop_back();
+        sparse_entry(id) = 0;
+        return true;
+    }
+
+    /** See return
+        @param[in] id Entity id
+        @return True if the id has a value */
+    bool contains(uint32_t id) const noexcept
+    {
+        return index_of(id) != npos;
+    }
+
+    /** Looks a value up by id
+        @param[in] id Entity id
+        @return The id's value, or nullptr if it has none */
+    T* find(uint32_t id) noexcept
+    {
+        auto index = index_of(id);
+        return index == npos ? nullptr : &values_[index];
+    }
+
+    /** Looks a value up by id
+        @param[in] id Entity id
+        @return The id's constant value, or nullptr if it has none */
+    const T* find(uint32_t id) const noexcept
+    {
+        auto index = index_of(id);
+        return index == npos ? nullptr : &values_[index];
+    }
+
+    /** Reorders the packed values so ids shared with another set come first, in the same order as in that set.
+        Joins which then walk both sets in step read both packed arrays sequentially.
+        @param[in] other Set whose order to follow */
+    template <typename U>
+    void sort_as(const sparse_set<U>& other)
+    {
+        size_t next = 0;
+        for (auto id : other.ids())
+        {
+            auto index = index_of(id);
+            if (index != npos)
+            {
+                swap_positions(index, next++);
+            }
+        }
+    }
+
+    /** Erases every value. Pages of the sparse index are kept for reuse. */
+    void clear() noexcept
+    {
+        for (auto id : ids_)
+        {
+            pages_[id / page_size][id % page_size] = 0;
+        }
+        while (!values_.empty())
+        {
+            values_.pop_back();
+        }
+        ids_.resize(0);
+    }
+
+    /** See return
+        @return Amount of ids with a value */
+    size_t size() const noexcept
+    {
+        return ids_.size();
+    }
+
+    /** See return
+        @return True if at least 1 id has a value */
+    bool empty() const noexcept
+    {
+        return ids_.empty();
+    }
+
+    /** See return
+        @return The id of every packed value, in the same order as the values */
+    std::span<const uint32_t> ids() const noexcept
+    {
+        return std::span<const uint32_t>(ids_.data(), ids_.size());
+    }
+
+    /** See return
+        @return Returns the iterator to the first packed value */
+    iterator begin() noexcept
+    {
+        return values_.begin();
+    }
+
+    /** See return
+        @return Returns the iterator to 1 past the last packed value */
+    iterator end() noexcept
+    {
+        return values_.end();
+    }
+
+    /** See return
+        @return Returns the constant iterator to the first packed value */
+    const_iterator begin() const noexcept
+    {
+        return values_.begin();
+    }
+
+    /** See return
+        @return Returns the constant iterator to 1 past the last packed value */
+    const_iterator end() const noexcept
+    {
+        return values_.end();
+    }
+
+private:
+    static constexpr size_t npos = size_t(-1);
+
+    custom_vector<T> values_;
+    custom_vector<uint32_t> ids_;
+    custom_vector<std::unique_ptr<uint32_t[]>> pages_;  ///< Packed index plus 1 for every id, 0 where there is no value
+
+    /** See return
+        @param[in] id Entity id
+        @return Packed index of the id's value, or npos if it has none */
+    size_t index_of(uint32_t id) const noexcept
+    {
+        auto page = id / page_size;
+        if (page >= pages_.size() || !pages_[page])
+        {
+            return npos;
+        }
+        auto entry = pages_[page][id % page_size];
+        return entry == 0 ? npos : entry - 1;
+    }
+
+    /** Finds the sparse index entry of an id, allocating its page if needed
+        @param[in] id Entity id
+        @return The entry */
+    uint32_t& sparse_entry(uint32_t id)
+    {
+        auto page = id / page_size;
+        if (page >= pages_.size())
+        {
+            if (page >= pages_.capacity())
+            {
+                pages_.reserve(std::max(page + 1, pages_.capacity() + pages_.capacity() / 2));
+            }
+            while (pages_.size() <= page)
+            {
+                pages_.emplace_back();
+            }
+        }
+        if (!pages_[page])
+        {
+            pages_[page] = std::make_unique<uint32_t[]>(page_size);
+        }
+        return pages_[page][id % page_size];
+    }
+
+    /** Swaps two packed values along with their ids
+        @param[in] a Packed index of one value
+        @param[in] b Packed index of the other value */
+    void swap_positions(size_t a, size_t b)
+    {
+        if (a == b)
+        {
+            return;
+        }
+
+        using std::swap;
+        swap(values_[a], values_[b]);
+        swap(ids_[a], ids_[b]);
+        sparse_entry(ids_[a]) = uint32_t(a + 1);
+        sparse_entry(ids_[b]) = uint32_t(b + 1);
+    }
+};
+
+/** Calls f(id, values...) for every id which has a value in all of the sets. Walks the ids of the smallest set and
+    looks each up in the others, so the cost depends on the smallest set only.
+    @note The sets must not be changed during the call, apart from assigning to the values passed to f
+    @param[in] f Callable which receives an id and a reference to its value in each set, in the order of the sets
+    @param[in] sets Sets to intersect */
+template <typename F, typename... Sets>
+void for_each_intersection(F f, Sets&... sets)
+{
+    static_assert(sizeof...(Sets) > 0, "Intersection needs at least one set");
+
+    std::span<const uint32_t> smallest;
+    auto smallest_size = std::min({ sets.size()... });
+    bool picked = false;
+    ((!picked && sets.size() == smallest_size ? (smallest = sets.ids(), picked = true) : false), ...);
+
+    for (auto id : smallest)
+    {
+        if ((sets.contains(id) && ...))
+        {
+            f(id, *sets.find(id)...);
+        }
+    }
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "custom_vector.h"
+#include "layout_report.h"
+
+/** Lists members of a type by pointer, to say which go in which array of a split_vector */
+template <auto... Members>
+struct fields {};
+
+template <typename T, typename Hot, typename Cold>
+class split_vector;
+
+/** A vector which stores the members of T in two parallel arrays: hot members, which scans read, and cold members,
+    which they don't. Scans over the hot array only pull hot members into the cache. Each array stores its members as
+    a std::tuple, which pads between them just as a struct does, e.g. a hot tuple<char, double> still takes 16 bytes;
+    only padding T needs between a hot and a cold member goes away.
+
+    Members are chosen by listing pointers to them, e.g. split_vector<T, fields<&T::id>, fields<&T::name, &T::notes>>.
+    Every member should be listed once. For aggregates this is checked at compile time. Member arrays are stored as
+    std::array. Reading a whole object back default constructs a T and assigns every listed member. */
+template <typename T, auto... HotMembers, auto... ColdMembers>
+class split_vector<T, fields<HotMembers...>, fields<ColdMembers...>>
+{
+    /** Type a member is stored as: itself, or a std::array for a member array */
+    template <typename M>
+    struct storage
+    {
+        using type = M;
+    };
+
+    template <typename E, size_t N>
+    struct storage<E[N]>
+    {
+        using type = std::array<E, N>;
+    };
+
+    template <auto Member>
+    using storage_t = typename storage<typename layout_detail::member_pointer<decltype(Member)>::member_type>::type;
+
+public:
+    /** Hot members of one object */
+    using hot_type = std::tuple<storage_t<HotMembers>...>;
+
+    /** Cold members of one object */
+    using cold_type = std::tuple<storage_t<ColdMembers>...>;
+
+    /** Default constructor */
+    split_vector() = default;
+
+    /** Adds an object to the end of the vector, splitting its members between the two arrays
+        @param[in] t Object to add */
+    void push_back(const T& t)
+    {
+        hot_.push_back(hot_type{ load(t.*HotMembers)... });
+        cold_.push_back(cold_type{ load(t.*ColdMembers)... });
+    }
+
+    /** Indexing operator. Reassembles a whole object, so use get() or hot() to read single members in scans.
+        @param[in] index Offset into the vector
+        @return A copy of the object at the index given */
+    T operator[] (size_t index) const
+    {
+        T t{};
+        std::apply([&t](const auto&... members) { (store(t.*HotMembers, members), ...); }, hot_[index]);
+        std::apply([&t](const auto&... members) { (store(t.*ColdMembers, members), ...); }, cold_[index]);
+        return t;
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return The stored member of the object at the index given, in whichever array it lives */
+    template <auto Member>
+    auto& get(size_t index) noexcept
+    {
+        if constexpr (index_of<Member, HotMembers...>() < sizeof...(HotMembers))
+        {
+            return std::get<index_of<Member, HotMembers...>()>(hot_[index]);
+        }
+        else
+        {
+            static_assert(index_of<Member, ColdMembers...>() < sizeof...(ColdMembers), "Member isn't stored");
+            return std::get<index_of<Member, ColdMembers...>()>(cold_[index]);
+        }
+    }
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return The constant stored member of the object at the index given, in whichever array it lives */
+    template <auto Member>
+    const auto& get(size_t index) const noexcept
+    {
+        return const_cast<split_vector&>(*this).template get<Member>(index);
+    }
+
+    /** See return
+        @return The hot members of every object, for scans */
+    std::span<const hot_type> hot() const noexcept
+    {
+        return std::span<const hot_type>(hot_.data(), hot_.size());
+    }
+
+    /** See return
+        @return The cold members of every object */
+    std::span<const cold_type> cold() const noexcept
+    {
+        return std::span<const cold_type>(cold_.data(), cold_.size());
+    }
+
+    /** Increases capacity to hold at least count objects
+        @param[in] count Amount of objects the vector should have room for */
+    void reserve(size_t count)
+    {
+        hot_.reserve(count);
+        cold_.reserve(count);
+    }
+
+    /** Destructs all objects and deallocates memory */
+    void clear() noexcept
+    {
+        hot_.clear();
+        cold_.clear();
+    }
+
+    /** See return
+        @return Amount of objects stored */
+    size_t size() const noexcept
+    {
+        return hot_.size();
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 object stored */
+    bool empty() const noexcept
+    {
+        return hot_.empty();
+    }
+
+private:
+    custom_vector<hot_type> hot_;
+    custom_vector<cold_type> cold_;
+
+    /** See return
+        @return True if every member of T is listed, for aggregates. Other types can't be checked. */
+    static constexpr bool lists_every_member() noexcept
+    {
+        if constexpr (std::is_aggregate_v<T>)
+        {
+            auto listed = (size_t(0) + ... + sizeof(storage_t<HotMembers>)) + (size_t(0) + ... + sizeof(storage_t<ColdMembers>));
+            return layout_of<T>().members == sizeof...(HotMembers) + sizeof...(ColdMembers) && layout_of<T>().member_bytes == listed;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    static_assert(lists_every_member(), "Every member must be listed as hot or cold");
+
+    /** See return
+        @return Index of Member within Members, or the size of Members if it isn't there */
+    template <auto Member, auto... Members>
+    static constexpr size_t index_of() noexcept
+    {
+        size_t index = 0;
+        bool found = false;
+        ((found = found || same_member<Member, Members>(), index += found ? 0 : 1), ...);
+        return index;
+    }
+
+    /** See return
+        @return True if both pointers are to the same member */
+    template <auto A, auto B>
+    static constexpr bool same_member() noexcept
+    {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>)
+        {
+            return A == B;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /** See return
+        @param[in] m Member of an object
+        @return The member as it is stored */
+    template <typename M>
+    static const M& load(const M& m) noexcept
+    {
+        return m;
+    }
+
+    /** See return
+        @param[in] m Member array of an object
+        @return The member as it is stored */
+    template <typename E, size_t N>
+    static std::array<E, N> load(const E (&m)[N])
+    {
+        return std::to_array(m);
+    }
+
+    /** Writes a stored member back into an object
+        @param[out] m Member of the object
+        @param[in] value Stored member */
+    template <typename M>
+    static void store(M& m, const M& value)
+    {
+        m = value;
+    }
+
+    /** Writes a stored member array back into an object
+        @param[out] m Member array of the object
+        @param[in] value Stored member */
+    template <typename E, size_t N>
+    static void store(E (&m)[N], const std::array<E, N>& value)
+    {
+        std::copy(value.begin(), value.end(), m);
+    }
+};
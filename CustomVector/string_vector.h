@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <string_view>
+
+#include "custom_vector.h"
+
+/** A vector of strings which stores every character in one contiguous arena, plus where each string ends.
+    There is no per string allocation and no per string object, so scanning is a linear walk over memory and
+    growing only moves two buffers of trivially copyable data. Strings are read back as std::string_view, which
+    stays valid until the vector next grows. */
+class string_vector
+{
+public:
+    /** Default constructor */
+    string_vector() = default;
+
+    /** Adds a copy of a string to the end of the vector
+        @param[in] s String to add */
+    void push_back(std::string_view s)
+    {
+        // s may view this vector's own arena, which growing frees, so copy it from wherever it ends up
+        auto arena = chars_.data();
+        if (arena && std::less_equal<>()(arena, s.data()) && std::less<>()(s.data(), arena + chars_.size()))
+        {
+            auto offset = size_t(s.data() - arena);
+            chars_.resize(chars_.size() + s.size());
+            std::copy_n(chars_.data() + offset, s.size(), chars_.data() + chars_.size() - s.size());
+        }
+        else
+        {
+            chars_.append_range(s);
+        }
+        ends_.push_back(chars_.size());
+    }
+
+    /** Adds a copy of every string in a range, reserving room for all of their characters at once when the range
+        can be walked twice
+        @param[in] r Range of strings, or anything convertible to std::string_view */
+    template <std::ranges::input_range R>
+    void append_range(R&& r)
+    {
+        if constexpr (std::ranges::forward_range<R>)
+        {
+            size_t chars = 0;
+            size_t count = 0;
+            for (auto&& s : r)
+            {
+                chars += std::string_view(s).size();
+                ++count;
+            }
+            reserve(size() + count, chars_.size() + chars);
+        }
+
+        for (auto&& s : r)
+        {
+            push_back(std::string_view(s));
+        }
+    }
+
+    /** Indexing operator
+        @param[in] index Offset into the vector
+        @return A view of the string at the index given */
+    std::string_view operator[] (size_t index) const noexcept
+    {
+        auto first = begin_of(index);
+        return std::string_view(chars_.data() + first, ends_[index] - first);
+    }
+
+    /** Finds the first string containing a substring. Searches the arena directly rather than string by string.
+        @param[in] needle Substring to look for
+        @param[in] from Index of the first string to consider
+        @return Index of the first string at or after from which contains needle, or size() if there is none */
+    size_t find(std::string_view needle, size_t from = 0) const noexcept
+    {
+        if (from >= size() || needle.empty())
+        {
+            return std::min(from, size());
+        }
+
+        std::string_view arena(chars_.data(), chars_.size());
+        auto pos = begin_of(from);
+        for (;;)
+        {
+            pos = arena.find(needle, pos);
+            if (pos == std::string_view::npos)
+            {
+                return size();
+            }
+
+            // Matches which run past the end of the string they start in span two strings, and so do all later
+            // matches starting in the same string, so the search carries on from the next string
+            auto index = size_t(std::upper_bound(ends_.begin() + from, ends_.end(), pos) - ends_.begin());
+            if (pos + needle.size() <= ends_[index])
+            {
+                return index;
+            }
+            pos = ends_[index];
+        }
+    }
+
+    /** See return
+        @param[in] needle Substring to look for
+        @return Index of every string which contains needle, in order */
+    custom_vector<size_t> find_all(std::string_view needle) const
+    {
+        custom_vector<size_t> found;
+        for (auto index = find(needle); index < size(); index = find(needle, index + 1))
+        {
+            found.push_back(index);
+        }
+        return found;
+    }
+
+    /** Increases capacity if the new capacities are greater than the current
+        @param[in] count Amount of strings the vector should have room for
+        @param[in] chars Amount of characters the vector should have room for in total */
+    void reserve(size_t count, size_t chars)
+    {
+        ends_.reserve(count);
+        chars_.reserve(chars);
+    }
+
+    /** Removes every string and deallocates memory */
+    void clear() noexcept
+    {
+        chars_.clear();
+        ends_.clear();
+    }
+
+    /** See return
+        @return Amount of strings stored */
+    size_t size() const noexcept
+    {
+        return ends_.size();
+    }
+
+    /** See return
+        @return True if the vector currently has at least 1 string stored */
+    bool empty() const noexcept
+    {
+        return ends_.empty();
+    }
+
+    /** See return
+        @return Every character of every string, back to back */
+    std::span<const char> chars() const noexcept
+    {
+        return std::span<const char>(chars_.data(), chars_.size());
+    }
+
+private:
+    custom_vector<char> chars_;
+    custom_vector<size_t> ends_;    ///< Offset 1 past the last character of each string
+
+    /** See return
+        @param[in] index Offset into the vector
+        @return Offset of the first character of the string at the index given */
+    size_t begin_of(size_t index) const noexcept
+    {
+        return index == 0 ? 0 : ends_[index - 1];
+    }
+};
@@ -62,6 +62,15 @@ struct non_movable
 
 //------------------------------------------------------------------------------
 
+struct no_default
+{
+    no_default(int new_i) : i(new_i) {}
+
+    int i;
+};
+
+//------------------------------------------------------------------------------
+
 struct different_variables
 {
     different_variables() = default;
@@ -1,10 +1,37 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
 #include <exception>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "aosoa_vector.h"
+#include "bit_vector.h"
+#include "combinable_vector.h"
+#include "concurrent_filler.h"
 #include "custom_vector.h"
+#include "delta_vector.h"
+#include "dict_vector.h"
+#include "epoch_vector.h"
+#include "layout_report.h"
+#include "nullable_vector.h"
+#include "poly_vector.h"
+#include "read_mostly_vector.h"
+#include "rle_vector.h"
+#include "shared_vector.h"
+#include "slot_map.h"
+#include "sparse_set.h"
+#include "split_vector.h"
+#include "string_vector.h"
 #include "test_structs.h"
 
 class test_failed_exception : public std::exception
@@ -193,7 +220,7 @@ std::string test_copy_swap()
         vec1.push_back("hello ");
         vec1.push_back("world!");
 
-        // Invokes both the copy-constructor and assigment operator
+        // Invokes the copy assignment operator
         vec2 = vec1;
 
         // Both size should be equal here as they were copied
@@ -211,7 +238,7 @@ std::string test_copy_swap()
 
         check_size(vec2.size(), 0);
 
-        // Invokes the move-constructor and assignment operator
+        // Invokes the move assignment operator
         vec2 = std::move(vec1);
 
         check_size(vec1.size(), 0);
@@ -322,3 +349,1742 @@ std::string test_weird_alignment()
 
     return func + " passed";
 }
+
+std::string test_spans()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        custom_vector<int> vec;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            vec.push_back(i);
+        }
+
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "span element", actual, expected);
+        };
+
+        // Views don't copy, so writing through them writes to the vector
+        auto middle = vec.subspan(2, 4);
+        check_element(middle.size(), 4u);
+        check_element(middle[0], 2);
+        middle[0] = 42;
+        check_element(vec[2], 42);
+
+        auto tail = vec.subspan(6);
+        check_element(tail.size(), 2u);
+        check_element(tail[1], 7);
+
+        const auto& cvec = vec;
+        auto sliced = cvec.slice(1, 3);
+        check_element(sliced.size(), 2u);
+        check_element(sliced[1], 42);
+
+        // Constant iteration must not hand out mutable references
+        static_assert(std::is_same_v<decltype(*cvec.begin()), const int&>);
+        static_assert(std::is_same_v<decltype(sliced), std::span<const int>>);
+
+        // Standard algorithms work with the iterators
+        std::copy(cvec.begin() + 4, cvec.end(), vec.begin());
+        check_element(vec[0], 4);
+        check_element(vec[3], 7);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_from_range()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "range element", actual, expected);
+        };
+
+        auto check_capacity = [&func](size_t actual, size_t expected)
+        {
+            require_equal(func, "vector capacity", actual, expected);
+        };
+
+        // Sized ranges allocate exactly what they need
+        auto squares = custom_vector<int>::from_range(std::views::iota(0, 10) | std::views::transform([](int i) { return i * i; }));
+        check_element(squares.size(), 10u);
+        check_capacity(squares.capacity(), 10);
+        check_element(squares[9], 81);
+
+        // Filtered ranges are not sized, so the hint is used and the excess trimmed
+        auto evens = custom_vector<int>::from_range(squares | std::views::filter([](int i) { return i % 2 == 0; }), squares.size());
+        check_element(evens.size(), 5u);
+        check_capacity(evens.capacity(), 5);
+        check_element(evens[4], 64);
+
+        // Without a hint the vector simply grows
+        auto odds = custom_vector<int>::from_range(squares | std::views::filter([](int i) { return i % 2 != 0; }));
+        check_element(odds.size(), 5u);
+        check_element(odds[0], 1);
+
+        // Iterator pairs work as well
+        const char* letters[] = { "a", "b", "c" };
+        custom_vector<std::string> strings(std::begin(letters), std::end(letters));
+        check_element(strings.size(), 3u);
+        check_capacity(strings.capacity(), 3);
+        check_element(strings[2], "c");
+
+        strings.append_range(std::views::take(letters, 2));
+        check_element(strings.size(), 5u);
+        check_element(strings[4], "b");
+
+        // Repeated small appends grow geometrically rather than reallocating every time
+        custom_vector<int> pairs;
+        size_t reallocations = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            auto old_cap = pairs.capacity();
+            pairs.append_range(std::views::iota(0, 2));
+            reallocations += pairs.capacity() != old_cap;
+        }
+        check_element(pairs.size(), 2000u);
+        check_element(reallocations < 20, true);
+
+        size_t resizes = 0;
+        for (size_t n = 1; n <= 1000; ++n)
+        {
+            auto old_cap = pairs.capacity();
+            pairs.resize(2000 + n);
+            resizes += pairs.capacity() != old_cap;
+        }
+        check_element(resizes < 5, true);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_adopt_release()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "buffer element", actual, expected);
+        };
+
+        static int frees = 0;
+        auto c_free = [](int* buffer, size_t) { std::free(buffer); ++frees; };
+
+        // Pretend this buffer came from a C API
+        auto buffer = static_cast<int*>(std::malloc(4 * sizeof(int)));
+        for (int i = 0; i < 3; ++i)
+        {
+            buffer[i] = i + 1;
+        }
+
+        custom_vector<int> vec;
+        vec.adopt(buffer, 3, 4, c_free);
+
+        // No copies were made
+        check_element(vec.data(), buffer);
+        check_element(vec.size(), 3u);
+        check_element(vec.capacity(), 4u);
+
+        vec.push_back(4);
+        check_element(vec.data(), buffer);
+        check_element(frees, 0);
+
+        // Growing hands the old buffer back to its deleter
+        vec.push_back(5);
+        check_element(frees, 1);
+        check_element(vec[4], 5);
+
+        // Releasing gives away the vector's own buffer
+        auto released = vec.release();
+        check_element(vec.size(), 0u);
+        check_element(vec.data(), static_cast<int*>(nullptr));
+        check_element(released.size, 5u);
+        check_element(released.data[0], 1);
+
+        // And it can be adopted straight back
+        custom_vector<int> other;
+        other.adopt(released.data, released.size, released.capacity, released.deleter);
+        check_element(other.data(), released.data);
+        check_element(other[4], 5);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+std::string test_shared_vector()
+{
+    const std::string& func = __FUNCTION__;
+    const std::string name = "/custom_vector_test_" + std::to_string(::getpid());
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "shared element", actual, expected);
+        };
+
+        auto writer = shared_vector<uint64_t>::create(name, 2);
+        writer.push_back(1);
+        writer.push_back(2);
+
+        // A second mapping of the same segment lands at a different address, like it would in another process
+        auto reader = shared_vector<uint64_t>::open(name);
+        require_unequal(func, "mapping address", uintptr_t(reader.data()), uintptr_t(writer.data()));
+        check_element(reader.size(), 2u);
+        check_element(reader[1], 2u);
+
+        // Growing the segment is only visible to the reader once it refreshes its mapping
+        uint64_t more[] = { 3, 4, 5, 6 };
+        writer.append(more);
+        check_element(writer.size(), 6u);
+        check_element(reader.size(), 2u);
+        check_element(reader.refresh(), 6u);
+        check_element(reader[5], 6u);
+
+        // The wrong type is refused
+        bool refused = false;
+        try
+        {
+            shared_vector<uint32_t>::open(name);
+        }
+        catch (const std::system_error&)
+        {
+            refused = true;
+        }
+        check_element(refused, true);
+
+        // An existing segment isn't replaced unless asked to, so a live writer can't lose its name
+        int error = 0;
+        try
+        {
+            shared_vector<uint64_t>::create(name, 2);
+        }
+        catch (const std::system_error& e)
+        {
+            error = e.code().value();
+        }
+        check_element(error, EEXIST);
+        check_element(shared_vector<uint64_t>::open(name).size(), 6u);
+
+        auto replacement = shared_vector<uint64_t>::create(name, 2, true);
+        check_element(shared_vector<uint64_t>::open(name).size(), 0u);
+
+        // A segment whose creator hasn't written the header yet is reported as such, not as a different type
+        shared_vector<uint64_t>::unlink(name);
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        check_element(::ftruncate(fd, 4096), 0);
+        error = 0;
+        try
+        {
+            shared_vector<uint64_t>::open(name);
+        }
+        catch (const std::system_error& e)
+        {
+            error = e.code().value();
+        }
+        ::close(fd);
+        check_element(error, EAGAIN);
+
+        // Capacities whose size can't be represented are refused rather than wrapping around
+        error = 0;
+        try
+        {
+            replacement.reserve(std::numeric_limits<size_t>::max() / 4);
+        }
+        catch (const std::system_error& e)
+        {
+            error = e.code().value();
+        }
+        check_element(error, EOVERFLOW);
+    }
+    catch (test_failed_exception e)
+    {
+        shared_vector<uint64_t>::unlink(name);
+        return e.what();
+    }
+
+    shared_vector<uint64_t>::unlink(name);
+    return func + " passed";
+}
+#endif
+
+std::string test_read_mostly_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "snapshot element", actual, expected);
+        };
+
+        read_mostly_vector<uint64_t> config;
+        check_element(config.get(0).has_value(), false);
+
+        // Every batch keeps all elements equal, so a torn snapshot would have differing elements
+        std::atomic<bool> done = false;
+        std::atomic<size_t> torn = 0;
+        std::atomic<size_t> snapshots = 0;
+
+        custom_vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.emplace_back([&]
+            {
+                custom_vector<uint64_t> snapshot;
+                while (!done)
+                {
+                    config.snapshot(snapshot);
+                    if (!std::all_of(snapshot.begin(), snapshot.end(), [&](uint64_t v) { return v == snapshot[0]; }))
+                    {
+                        ++torn;
+                    }
+                    ++snapshots;
+                }
+            });
+        }
+
+        for (uint64_t batch = 1; batch <= 2000; ++batch)
+        {
+            if (batch % 100 == 0)
+            {
+                // Grow now and then so readers see buffers being replaced. The new element matches the others.
+                config.push_back(batch - 1);
+            }
+            config.modify([batch](std::span<uint64_t> values) { std::fill(values.begin(), values.end(), batch); });
+        }
+
+        done = true;
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+
+        check_element(torn.load(), 0u);
+        check_element(config.size(), 20u);
+        check_element(*config.get(19), 2000u);
+        check_element(config.snapshot()[0], 2000u);
+
+        uint64_t replacement[] = { 7, 8 };
+        config.assign(replacement);
+        check_element(config.size(), 2u);
+        check_element(*config.get(1), 8u);
+
+        // A throwing modification publishes nothing and leaves readers free to continue
+        bool thrown = false;
+        try
+        {
+            config.modify([](std::span<uint64_t> objects)
+            {
+                objects[0] = 9;
+                throw std::runtime_error("modify failed");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        check_element(thrown, true);
+        check_element(*config.get(0), 7u);
+        check_element(config.snapshot().size(), 2u);
+
+        // Buffers replaced by growth are freed once no reader is pinned, rather than kept until destruction
+        epoch_domain domain;
+        read_mostly_vector<uint32_t> grown(domain);
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            grown.push_back(i);
+        }
+        check_element(domain.collect(), 0u);
+        {
+            auto pinned = domain.pin();
+            for (uint32_t i = 0; i < 100; ++i)
+            {
+                grown.push_back(i);
+            }
+            check_element(domain.collect() > 0, true);
+        }
+        grown.set(0, 5);
+        check_element(domain.collect(), 0u);
+        check_element(*grown.get(0), 5u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_epoch_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "epoch element", actual, expected);
+        };
+
+        epoch_domain domain;
+        epoch_vector<size_t> vec(domain);
+
+        // Readers iterate while the writer keeps growing the vector underneath them
+        std::atomic<bool> done = false;
+        std::atomic<size_t> mismatches = 0;
+
+        custom_vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.emplace_back([&]
+            {
+                while (!done)
+                {
+                    auto view = vec.read();
+                    size_t expected = 0;
+                    for (auto v : view)
+                    {
+                        if (v != expected++)
+                        {
+                            ++mismatches;
+                        }
+                    }
+                }
+            });
+        }
+
+        for (size_t i = 0; i < 100000; ++i)
+        {
+            vec.push_back(i);
+        }
+
+        done = true;
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+
+        check_element(mismatches.load(), 0u);
+        check_element(vec.size(), 100000u);
+
+        // A pinned view keeps the old buffer alive through growth
+        {
+            auto view = vec.read();
+            vec.reserve(vec.size() * 4);
+            check_element(domain.collect(), 1u);
+            check_element(view[99999], 99999u);
+        }
+
+        // Once nobody is pinned everything retired can be freed
+        check_element(domain.collect(), 0u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_concurrent_fill()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "filled element", actual, expected);
+        };
+
+        custom_vector<std::string> vec;
+        vec.push_back("already here");
+
+        const size_t count = 100000;
+        concurrent_filler<std::string> filler(vec, count);
+
+        // Each thread keeps claiming chunks and constructs the objects in place until the room runs out
+        custom_vector<std::thread> producers;
+        for (int i = 0; i < 8; ++i)
+        {
+            producers.emplace_back([&]
+            {
+                for (auto slots = filler.claim_n(777); !slots.empty(); slots = filler.claim_n(777))
+                {
+                    auto first = size_t(slots.data() - vec.data());
+                    for (size_t j = 0; j < slots.size(); ++j)
+                    {
+                        std::construct_at(&slots[j], std::to_string(first + j));
+                    }
+                    filler.constructed(slots.size());
+                }
+            });
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        check_element(filler.commit(), count);
+        check_element(vec.size(), count + 1);
+        check_element(vec[0], "already here");
+
+        size_t wrong = 0;
+        for (size_t i = 1; i < vec.size(); ++i)
+        {
+            wrong += vec[i] != std::to_string(i);
+        }
+        check_element(wrong, 0u);
+
+        // A filler abandoned without commit() still hands its objects to the vector, so none leak
+        custom_vector<std::string> abandoned;
+        {
+            concurrent_filler<std::string> early(abandoned, 10);
+            auto slots = early.claim_n(3);
+            for (auto& slot : slots)
+            {
+                std::construct_at(&slot, "a string long enough to need its own allocation");
+            }
+            early.constructed(slots.size());
+        }
+        check_element(abandoned.size(), 3u);
+        check_element(abandoned[2].size(), 47u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_combinable_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "combined element", actual, expected);
+        };
+
+        // Keyed buffers combine in key order no matter which thread finishes first
+        const size_t per_thread = 100000;
+        combinable_vector<uint64_t> numbers;
+        custom_vector<std::thread> workers;
+        for (size_t t = 0; t < 4; ++t)
+        {
+            workers.emplace_back([&numbers, t]
+            {
+                auto& local = numbers.local(3 - t);
+                for (size_t i = 0; i < per_thread; ++i)
+                {
+                    local.push_back((3 - t) * per_thread + i);
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        auto combined = numbers.combine();
+        check_element(combined.size(), 4 * per_thread);
+        size_t wrong = 0;
+        for (size_t i = 0; i < combined.size(); ++i)
+        {
+            wrong += combined[i] != i;
+        }
+        check_element(wrong, 0u);
+
+        // Buffers are emptied, so a second round starts fresh
+        check_element(numbers.combine().size(), 0u);
+
+        // Objects which aren't trivially copyable are moved
+        combinable_vector<std::string> words;
+        custom_vector<std::thread> writers;
+        for (int t = 0; t < 3; ++t)
+        {
+            writers.emplace_back([&words]
+            {
+                words.local().push_back("word");
+                words.local().push_back("word");
+            });
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+
+        custom_vector<std::string> all;
+        all.push_back("first");
+        words.combine(all);
+        check_element(all.size(), 7u);
+        check_element(all[0], "first");
+        check_element(all[6], "word");
+
+        // Emptying buffers never needs a default constructor
+        combinable_vector<no_default> values;
+        values.local(0).push_back(no_default(4));
+        auto combined_values = values.combine();
+        check_element(combined_values.size(), 1u);
+        check_element(combined_values[0].i, 4);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+std::string test_prefault()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto minor_faults = []
+        {
+            rusage usage;
+            ::getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_minflt;
+        };
+
+        // Counts the page faults taken while filling a freshly reserved 64 MB vector
+        auto faults_while_filling = [&](const memory_options& options)
+        {
+            const size_t count = size_t(8) << 20;
+            custom_vector<uint64_t> vec;
+            vec.reserve(count, options);
+
+            auto before = minor_faults();
+            vec.resize(count);
+            return minor_faults() - before;
+        };
+
+        auto cold = faults_while_filling(memory_options{});
+        auto warm = faults_while_filling(memory_options{ true, false });
+        if (warm * 4 > cold)
+        {
+            std::stringstream ss;
+            ss << func << " fails: prefaulting didn't prevent page faults. Without: " << cold << ", With: " << warm;
+            throw test_failed_exception(ss.str());
+        }
+
+        // Locking may be refused by the locked memory limit, in which case the buffer is prefaulted instead
+        custom_vector<int> locked(memory_options{ false, true });
+        locked.push_back(1);
+        locked.resize(1000, 2);
+        require_equal(func, "locked element", locked[999], 2);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+#endif
+
+std::string test_numa_fill()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "numa element", actual, expected);
+        };
+
+        // Partitions cover every item exactly once, with sizes differing by at most 1
+        check_element(memory_policy::partition_begin(10, 3, 0), 0u);
+        check_element(memory_policy::partition_begin(10, 3, 1), 4u);
+        check_element(memory_policy::partition_begin(10, 3, 2), 7u);
+        check_element(memory_policy::partition_begin(10, 3, 3), 10u);
+
+        // Placement silently does nothing on single node machines, but the parallel fill must still be complete
+        const size_t count = size_t(4) << 20;
+        custom_vector<uint32_t> partitioned(count, 7u, memory_options{ false, false, numa_policy::partitioned });
+        check_element(partitioned.size(), count);
+        check_element(size_t(std::count(partitioned.begin(), partitioned.end(), 7u)), count);
+
+        custom_vector<uint64_t> interleaved(memory_options{ false, false, numa_policy::interleaved });
+        interleaved.push_back(1);
+        interleaved.resize(count);
+        check_element(interleaved.size(), count);
+        check_element(interleaved[0], 1u);
+        check_element(size_t(std::count(interleaved.begin(), interleaved.end(), 0u)), count - 1);
+
+        // Growing fills only the new objects, whichever partitions of the whole buffer they fall in
+        interleaved.resize(count * 2, 3);
+        check_element(interleaved[count * 2 - 1], 3u);
+        check_element(interleaved[count - 1], 0u);
+        check_element(size_t(std::count(interleaved.begin(), interleaved.end(), 3u)), count);
+
+        // Filling by copy never needs a default constructor, and value initializing never needs a copy constructor
+        custom_vector<no_default> filled(3, no_default(5));
+        filled.resize(5, no_default(6));
+        check_element(filled.size(), 5u);
+        check_element(filled[2].i, 5);
+        check_element(filled[4].i, 6);
+
+        custom_vector<non_copyable> moved_only;
+        moved_only.resize(3);
+        moved_only.resize(1);
+        check_element(moved_only.size(), 1u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_copy_reuse()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "copied element", actual, expected);
+        };
+
+        using counter_copy_t = counter<custom_vector<int>>;
+
+        custom_vector<std::string> source;
+        source.reserve(16);
+        source.push_back("a");
+        source.push_back("b");
+        source.push_back("c");
+
+        // Copies only allocate what they need
+        custom_vector<std::string> copy(source);
+        check_element(copy.capacity(), 3u);
+        check_element(copy[2], "c");
+
+        // Repeatedly snapshotting into the same scratch vector doesn't allocate once it is large enough
+        custom_vector<std::string> scratch;
+        source.push_back("d");
+        scratch = source;
+        auto buffer = scratch.data();
+        for (int i = 0; i < 3; ++i)
+        {
+            source.resize(3);
+            scratch = source;
+            check_element(scratch.data(), buffer);
+            check_element(scratch.size(), 3u);
+
+            source.push_back(std::to_string(i));
+            scratch = source;
+            check_element(scratch.data(), buffer);
+        }
+        check_element(scratch.size(), 4u);
+        check_element(scratch[3], "2");
+
+        // Shrinking destroys the extra objects
+        custom_vector<counter_copy_t> counters;
+        counters.resize(5);
+        custom_vector<counter_copy_t> fewer;
+        fewer.resize(2);
+        counters = fewer;
+        check_element(counters.size(), 2u);
+        check_element(counters.capacity(), 5u);
+        check_element(counter_copy_t::total(), 4);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_fallible_growth()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "fallible result", actual, expected);
+        };
+
+        custom_vector<int> vec;
+        check_element(vec.try_push_back(1), true);
+        check_element(vec.try_emplace_back(2), true);
+
+        // Far more than can ever be allocated
+        const size_t impossible = size_t(1) << 60;
+
+        auto old_data = vec.data();
+        auto old_capacity = vec.capacity();
+        check_element(vec.try_reserve(impossible), false);
+        check_element(vec.data(), old_data);
+        check_element(vec.capacity(), old_capacity);
+        check_element(vec.size(), 2u);
+        check_element(vec[1], 2);
+
+        bool threw = false;
+        try
+        {
+            vec.reserve(impossible);
+        }
+        catch (const std::bad_alloc&)
+        {
+            threw = true;
+        }
+        check_element(threw, true);
+        check_element(vec.size(), 2u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_constexpr()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "compile time table", actual, expected);
+        };
+
+        // Built entirely by the compiler, including every reallocation along the way, then copied into an array
+        constexpr auto squares = []
+        {
+            custom_vector<int> vec;
+            for (int i = 0; i < 20; ++i)
+            {
+                vec.push_back(i * i);
+            }
+
+            std::array<int, 20> table{};
+            std::copy(vec.begin(), vec.end(), table.begin());
+            return table;
+        }();
+        static_assert(squares[19] == 361);
+
+        // Objects which aren't trivially copyable, copies and resizing work in constant evaluation too
+        constexpr auto sizes = []
+        {
+            custom_vector<custom_vector<int>> rows;
+            for (int i = 0; i < 5; ++i)
+            {
+                rows.emplace_back();
+                rows[i].resize(i, i);
+            }
+
+            auto copy = rows;
+            copy.resize(3);
+            copy = rows;
+            rows.resize(2);
+            return std::array<size_t, 4>{ rows.size(), copy.size(), copy[4].size(), size_t(copy[4][3]) };
+        }();
+        static_assert(sizes[0] == 2 && sizes[1] == 5 && sizes[2] == 4 && sizes[3] == 4);
+
+        // The same code gives the same results at run time
+        custom_vector<int> vec;
+        for (int i = 0; i < 20; ++i)
+        {
+            vec.push_back(i * i);
+        }
+        check_element(std::equal(vec.begin(), vec.end(), squares.begin(), squares.end()), true);
+        check_element(squares[7], 49);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_bit_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "bit", actual, expected);
+        };
+
+        // Every third bit set, across several words and a partial last word
+        const size_t count = 1000;
+        bit_vector bits;
+        for (size_t i = 0; i < count; ++i)
+        {
+            bits.push_back(i % 3 == 0);
+        }
+        check_element(bits.size(), count);
+        check_element(bits.words().size(), 16u);
+        check_element(bits.count(), 334u);
+        check_element(bool(bits[999]), true);
+        check_element(bool(bits[998]), false);
+
+        // Proxies write single bits
+        bits[1] = true;
+        bits[0].flip();
+        check_element(bool(bits[0]), false);
+        check_element(bool(bits[1]), true);
+        bits[1] = bits[2];
+        check_element(bool(bits[1]), false);
+        bits[0] = true;
+
+        // Rank and select agree with a plain scan, with and without the index
+        auto check_rank_select = [&]
+        {
+            size_t ones = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                check_element(bits.rank(i), ones);
+                if (bits[i])
+                {
+                    check_element(bits.select(ones), i);
+                    ++ones;
+                }
+            }
+            check_element(bits.rank(count), ones);
+            check_element(bits.select(ones), count);
+        };
+        check_rank_select();
+        bits.build_rank_index();
+        check_element(bits.has_rank_index(), true);
+        check_rank_select();
+
+        // Ranges crossing word boundaries, and changes dropping the index
+        bits.set(60, 200);
+        check_element(bits.has_rank_index(), false);
+        check_element(bool(bits[59]), false);
+        check_element(bool(bits[60]), true);
+        check_element(bool(bits[199]), true);
+        check_element(bool(bits[200]), false);
+        bits.reset(0, count);
+        check_element(bits.count(), 0u);
+        bits.set(5, 7);
+        check_element(bits.count(), 2u);
+
+        // Bulk operations between vectors, never setting bits past the end
+        bit_vector evens(count);
+        bit_vector all(count + 100, true);
+        for (size_t i = 0; i < count; i += 2)
+        {
+            evens[i] = true;
+        }
+        check_element((evens & all).count(), 500u);
+        check_element((evens | bits).count(), 501u);
+        auto odds = evens;
+        odds ^= all;
+        check_element(odds.count(), 500u);
+        check_element(bool(odds[1]), true);
+        odds.flip();
+        check_element(odds == evens, true);
+
+        // Shrinking clears the bits which were dropped
+        all.resize(10);
+        all.resize(100);
+        check_element(all.count(), 10u);
+        all.resize(130, true);
+        check_element(all.count(), 40u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_nullable_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "nullable value", actual, expected);
+        };
+
+        nullable_vector<double> empty;
+        check_element(empty.sum(), 0.0);
+        check_element(empty.min().has_value(), false);
+
+        // Nulls at every fifth position, spanning several bitmap words
+        nullable_vector<double> vec;
+        double sum = 0;
+        for (int i = 0; i < 150; ++i)
+        {
+            if (i % 5 == 0)
+            {
+                vec.push_back(std::nullopt);
+            }
+            else
+            {
+                vec.push_back(i - 100.5);
+                sum += i - 100.5;
+            }
+        }
+        vec.push_back(std::optional<double>(1000.0));
+        vec.push_back(std::optional<double>());
+        sum += 1000.0;
+
+        check_element(vec.size(), 152u);
+        check_element(vec.null_count(), 31u);
+        check_element(vec[0].has_value(), false);
+        check_element(*vec[1], -99.5);
+        check_element(vec.valid(150), true);
+        check_element(vec.valid(151), false);
+
+        // Null positions would change every aggregate if they weren't masked out
+        check_element(vec.sum(), sum);
+        check_element(*vec.min(), -99.5);
+        check_element(*vec.max(), 1000.0);
+
+        nullable_vector<int> nulls;
+        nulls.push_back(std::nullopt);
+        nulls.push_back(std::nullopt);
+        check_element(nulls.null_count(), 2u);
+        check_element(nulls.max().has_value(), false);
+        nulls.push_back(-3);
+        check_element(*nulls.max(), -3);
+        check_element(*nulls.min(), -3);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_dict_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "dictionary value", actual, expected);
+        };
+
+        dict_vector<std::string> names;
+        check_element(names.find("a").has_value(), false);
+        check_element(names.count("a"), 0u);
+
+        // A few hundred distinct values repeated many times, outgrowing 8 bit codes
+        const int distinct = 300;
+        for (int i = 0; i < 3000; ++i)
+        {
+            names.push_back("name " + std::to_string(i % distinct));
+            if (i == 255)
+            {
+                check_element(names.code_size(), 1u);
+            }
+        }
+        check_element(names.size(), 3000u);
+        check_element(names.dictionary().size(), size_t(distinct));
+        check_element(names.code_size(), 2u);
+
+        // Widening kept every code
+        check_element(names[0], "name 0");
+        check_element(names[299], "name 299");
+        check_element(names[2999], "name 299");
+        check_element(names.view(1234), std::string_view("name 34"));
+        check_element(names.code(1234), 34u);
+
+        // Filters compare codes
+        check_element(names.count("name 7"), 10u);
+        auto matches = names.equal_to("name 7");
+        check_element(matches.size(), 3000u);
+        check_element(matches.count(), 10u);
+        check_element(bool(matches[307]), true);
+        check_element(names.equal_to("missing").count(), 0u);
+
+        // Dictionaries work for other types too
+        dict_vector<int> numbers;
+        for (int i = 0; i < 70000; ++i)
+        {
+            numbers.push_back(i);
+        }
+        check_element(numbers.code_size(), 4u);
+        check_element(numbers[69999], 69999);
+        check_element(*numbers.find(65536), 65536u);
+        numbers.clear();
+        check_element(numbers.code_size(), 1u);
+        numbers.push_back(5);
+        check_element(numbers[0], 5);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_string_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "string", actual, expected);
+        };
+
+        string_vector strings;
+        strings.push_back("alpha");
+        strings.push_back("");
+        strings.push_back("beta");
+        check_element(strings.size(), 3u);
+        check_element(strings[0], std::string_view("alpha"));
+        check_element(strings[1].empty(), true);
+        check_element(strings[2], std::string_view("beta"));
+
+        // Every character lands in the one arena
+        custom_vector<std::string> words;
+        words.push_back("gamma");
+        words.push_back("delta");
+        words.push_back("alphabet");
+        strings.append_range(words);
+        check_element(strings.size(), 6u);
+        check_element(strings.chars().size(), 27u);
+        check_element(strings[5], std::string_view("alphabet"));
+
+        // "abe" spans "alpha" and "beta" in the arena, which mustn't count as a match
+        check_element(strings.find("abe"), 5u);
+        check_element(strings.find("alpha"), 0u);
+        check_element(strings.find("alpha", 1), 5u);
+        check_element(strings.find("ta"), 2u);
+        check_element(strings.find("missing"), 6u);
+        check_element(strings.find(""), 0u);
+
+        auto found = strings.find_all("a");
+        check_element(found.size(), 5u);
+        check_element(found[1], 2u);
+        check_element(found[4], 5u);
+
+        // Many small appends keep their contents
+        string_vector numbers;
+        for (int i = 0; i < 1000; ++i)
+        {
+            numbers.push_back(std::to_string(i));
+        }
+        check_element(numbers[999], std::string_view("999"));
+        check_element(numbers.find("99"), 99u);
+        check_element(numbers.find_all("99").size(), 19u);
+
+        // Appending a view of the vector's own arena survives the arena moving
+        string_vector repeated;
+        repeated.push_back("abc");
+        for (int i = 0; i < 10; ++i)
+        {
+            repeated.push_back(repeated[repeated.size() - 1]);
+        }
+        check_element(repeated.size(), 11u);
+        check_element(repeated[10], "abc");
+        check_element(repeated.chars().size(), 33u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_rle_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "run length value", actual, expected);
+        };
+
+        // Runs of 1, 2, 3... copies of each value
+        custom_vector<int> plain;
+        for (int value = 1; value <= 20; ++value)
+        {
+            for (int i = 0; i < value; ++i)
+            {
+                plain.push_back(value);
+            }
+        }
+
+        auto runs = rle_vector<int>::from_range(plain);
+        check_element(runs.size(), plain.size());
+        check_element(runs.run_count(), 20u);
+        for (size_t i = 0; i < plain.size(); ++i)
+        {
+            check_element(runs[i], plain[i]);
+        }
+        check_element(runs.run_of(0), 0u);
+        check_element(runs.run_of(3), 2u);
+
+        // Equal values extend the last run
+        runs.push_back(20, 5);
+        runs.push_back(20);
+        runs.push_back(7, 0);
+        check_element(runs.run_count(), 20u);
+        check_element(runs.size(), plain.size() + 6);
+        runs.push_back(0);
+        check_element(runs.run_count(), 21u);
+        check_element(runs[runs.size() - 1], 0);
+
+        size_t total = 0;
+        int last = 0;
+        runs.for_each_run([&](int value, size_t count)
+        {
+            total += count;
+            last = value;
+        });
+        check_element(total, runs.size());
+        check_element(last, 0);
+
+        auto decoded = runs.decode();
+        check_element(decoded.size(), runs.size());
+        check_element(decoded.capacity(), runs.size());
+        check_element(decoded[209], 20);
+        check_element(decoded[216], 0);
+
+        runs.clear();
+        check_element(runs.empty(), true);
+        check_element(runs.size(), 0u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_delta_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "delta value", actual, expected);
+        };
+
+        // Ascending timestamps with small irregular gaps, plus a run of equal values and one huge jump
+        custom_vector<uint64_t> plain;
+        uint64_t value = 1'700'000'000'000;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            value += (i * 7919) % 13;
+            if (i == 900)
+            {
+                value += uint64_t(1) << 62;
+            }
+            plain.push_back(value);
+        }
+
+        delta_vector deltas;
+        for (auto v : plain)
+        {
+            deltas.push_back(v);
+        }
+        check_element(deltas.size(), plain.size());
+        for (size_t i = 0; i < plain.size(); ++i)
+        {
+            check_element(deltas[i], plain[i]);
+        }
+
+        // Gaps below 16 pack into about 11 bits per value
+        delta_vector dense;
+        for (size_t i = 0; i < 100 * delta_vector::block_size; ++i)
+        {
+            dense.push_back(i * 15);
+        }
+        check_element(dense.memory_usage() * 4 < dense.size() * sizeof(uint64_t), true);
+
+        // Seeking agrees with a plain binary search, across blocks and into the unsealed tail
+        for (size_t i = 0; i < plain.size(); i += 37)
+        {
+            for (auto probe : { plain[i] - 1, plain[i], plain[i] + 1 })
+            {
+                auto expected = size_t(std::lower_bound(plain.begin(), plain.end(), probe) - plain.begin());
+                check_element(deltas.lower_bound(probe), expected);
+            }
+        }
+        check_element(deltas.lower_bound(0), 0u);
+        check_element(deltas.lower_bound(~uint64_t(0)), plain.size());
+
+        custom_vector<uint64_t> decoded;
+        decoded.push_back(1);
+        deltas.decode(decoded);
+        check_element(decoded.size(), plain.size() + 1);
+        check_element(std::equal(plain.begin(), plain.end(), decoded.begin() + 1), true);
+
+        // Full width distances and identical values both round trip
+        delta_vector extremes;
+        for (size_t i = 0; i < delta_vector::block_size; ++i)
+        {
+            extremes.push_back(i < 64 ? 0 : ~uint64_t(0));
+        }
+        for (size_t i = 0; i < delta_vector::block_size; ++i)
+        {
+            extremes.push_back(~uint64_t(0));
+        }
+        check_element(extremes[63], uint64_t(0));
+        check_element(extremes[64], ~uint64_t(0));
+        check_element(extremes[200], ~uint64_t(0));
+        check_element(extremes.lower_bound(1), 64u);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_poly_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "polymorphic object", actual, expected);
+        };
+
+        int alive = 0;
+
+        struct shape
+        {
+            explicit shape(int& alive) : alive_(&alive) { ++*alive_; }
+            shape(shape&& a) noexcept : alive_(a.alive_) { ++*alive_; }
+            virtual ~shape() { --*alive_; }
+            virtual std::string name() const = 0;
+            int* alive_;
+        };
+
+        struct square : shape
+        {
+            square(int& alive, int side) : shape(alive), side(side) {}
+            std::string name() const override { return "square " + std::to_string(side); }
+            int side;
+        };
+
+        // Over-aligned, so the buffer has to be reallocated with a stronger alignment
+        struct alignas(64) wide : shape
+        {
+            wide(int& alive, std::string label) : shape(alive), label(std::move(label)) {}
+            std::string name() const override { return label; }
+            std::string label;
+        };
+
+        // Base isn't the first subobject
+        struct tagged : std::string, shape
+        {
+            tagged(int& alive, const char* tag) : std::string(tag), shape(alive) {}
+            std::string name() const override { return *this; }
+        };
+
+        {
+            poly_vector<shape> shapes;
+            for (int i = 0; i < 100; ++i)
+            {
+                if (i % 3 == 0)
+                {
+                    shapes.emplace_back<square>(alive, i);
+                }
+                else if (i % 3 == 1)
+                {
+                    shapes.emplace_back<wide>(alive, "a string long enough to be allocated " + std::to_string(i));
+                }
+                else
+                {
+                    auto& t = shapes.emplace_back<tagged>(alive, "tagged");
+                    check_element(t.size(), 6u);
+                }
+            }
+            check_element(shapes.size(), 100u);
+            check_element(alive, 100);
+
+            // Objects survived every relocation and dispatch to their own type
+            check_element(shapes[0].name(), "square 0");
+            check_element(shapes[1].name(), "a string long enough to be allocated 1");
+            check_element(shapes[2].name(), "tagged");
+            check_element(shapes[99].name(), "square 99");
+            check_element(reinterpret_cast<uintptr_t>(&shapes[1]) % 64, 0u);
+
+            int count = 0;
+            for (auto& s : shapes)
+            {
+                count += s.name().empty() ? 0 : 1;
+            }
+            check_element(count, 100);
+
+            const auto& constant = shapes;
+            check_element(constant.begin()->name(), "square 0");
+
+            poly_vector<shape> moved(std::move(shapes));
+            check_element(moved.size(), 100u);
+            check_element(shapes.empty(), true);
+            check_element(alive, 100);
+        }
+        check_element(alive, 0);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_aosoa_vector()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "record", actual, expected);
+        };
+
+        // The fields of weird_alignment, without the padding between them
+        using wide_t = std::array<uint64_t, 4>;
+        aosoa_vector<8, char, wide_t, char> records;
+        for (int i = 0; i < 20; ++i)
+        {
+            records.push_back(char('a' + i), wide_t{ uint64_t(i), 0, 0, uint64_t(i) * 2 }, char('A' + i));
+        }
+        check_element(records.size(), 20u);
+        check_element(records.block_count(), 3u);
+        check_element(records.records_in_block(0), 8u);
+        check_element(records.records_in_block(2), 4u);
+
+        // Scalar access through references
+        check_element(std::get<0>(records[13]), 'n');
+        check_element(std::get<1>(records[13])[3], uint64_t(26));
+        check_element(records.get<2>(19), 'T');
+        std::get<0>(records[13]) = 'z';
+        check_element(records.get<0>(13), 'z');
+        records[0] = std::make_tuple('0', wide_t{}, '1');
+        check_element(records.get<2>(0), '1');
+
+        // Kernels run over whole aligned lane arrays
+        aosoa_vector<16, float, float, int> particles;
+        for (int i = 0; i < 100; ++i)
+        {
+            particles.push_back(float(i), 1.5f, i % 2);
+        }
+
+        float total = 0;
+        for (size_t b = 0; b < particles.block_count(); ++b)
+        {
+            auto positions = particles.lanes_of<0>(b);
+            auto speeds = particles.lanes_of<1>(b);
+            check_element(reinterpret_cast<uintptr_t>(positions.data()) % 64, 0u);
+            for (size_t lane = 0; lane < aosoa_vector<16, float, float, int>::lanes; ++lane)
+            {
+                positions[lane] += speeds[lane];
+            }
+            for (size_t lane = 0; lane < particles.records_in_block(b); ++lane)
+            {
+                total += positions[lane];
+            }
+        }
+        check_element(total, 4950.0f + 150.0f);
+        check_element(particles.get<0>(99), 100.5f);
+
+        const auto& constant = particles;
+        check_element(std::get<2>(constant[99]), 1);
+        check_element(constant.lanes_of<2>(6)[3], 1);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_layout()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "layout", actual, expected);
+        };
+
+        // weird_alignment has constructors, so its members are listed
+        constexpr auto weird = layout_of_members<&weird_alignment::c1, &weird_alignment::i, &weird_alignment::c2>();
+        static_assert(weird.size == 48 && weird.member_bytes == 34 && weird.padding == 14);
+        static_assert(weird.reordered_size == 40);
+
+        // Aggregates are reflected without listing anything, including member arrays
+        struct record
+        {
+            char tag;
+            double values[2];
+            char flag;
+            std::string name;
+        };
+        constexpr auto reflected = layout_of<record>();
+        static_assert(reflected.members == 4);
+        static_assert(reflected.member_bytes == 18 + sizeof(std::string));
+        check_element(reflected.padding, sizeof(record) - 18 - sizeof(std::string));
+
+        // Scans over the two characters only touch 2 bytes per object instead of 48
+        using split_t = split_vector<weird_alignment, fields<&weird_alignment::c1, &weird_alignment::c2>, fields<&weird_alignment::i>>;
+        static_assert(sizeof(split_t::hot_type) == 2);
+
+        split_t split;
+        for (int i = 0; i < 50; ++i)
+        {
+            split.push_back(weird_alignment(char('a' + i % 26), { i, i + 1, i + 2, i + 3 }, i % 2 ? 'y' : 'n'));
+        }
+        check_element(split.size(), 50u);
+
+        int yes = 0;
+        for (auto& [c1, c2] : split.hot())
+        {
+            yes += c2 == 'y' ? 1 : 0;
+        }
+        check_element(yes, 25);
+
+        check_element(split.get<&weird_alignment::c1>(27), 'b');
+        check_element(split.get<&weird_alignment::i>(10)[3], uint64_t(13));
+        split.get<&weird_alignment::c2>(0) = 'x';
+
+        // Whole objects are reassembled from both arrays
+        auto whole = split[0];
+        check_element(whole.c1, 'a');
+        check_element(whole.i[2], uint64_t(2));
+        check_element(whole.c2, 'x');
+
+        // Aggregates are checked for members left out
+        struct pair
+        {
+            int hot;
+            std::string cold;
+        };
+        split_vector<pair, fields<&pair::hot>, fields<&pair::cold>> pairs;
+        pairs.push_back(pair{ 1, "one" });
+        check_element(pairs[0].cold, "one");
+        check_element(std::get<0>(pairs.cold()[0]), "one");
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_slot_map()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "slot map object", actual, expected);
+        };
+
+        // pop_back destroys only the last object
+        custom_vector<std::string> strings;
+        strings.push_back("a");
+        strings.push_back("b");
+        strings.pop_back();
+        check_element(strings.size(), 1u);
+        check_element(strings.capacity(), 2u);
+
+        slot_map<std::string> names;
+        custom_vector<slot_map<std::string>::handle> handles;
+        for (int i = 0; i < 10; ++i)
+        {
+            handles.push_back(names.insert("name " + std::to_string(i)));
+        }
+        check_element(names.size(), 10u);
+        check_element(*names.find(handles[3]), "name 3");
+
+        // Erasing moves the last object into the gap without disturbing other handles
+        check_element(names.erase(handles[3]), true);
+        check_element(names.erase(handles[3]), false);
+        check_element(names.contains(handles[3]), false);
+        check_element(names.find(handles[3]) == nullptr, true);
+        check_element(names.size(), 9u);
+        check_element(*names.begin()[3].begin(), 'n');
+        check_element(names.begin()[3], "name 9");
+        for (int i = 0; i < 10; ++i)
+        {
+            if (i != 3)
+            {
+                check_element(*names.find(handles[i]), "name " + std::to_string(i));
+            }
+        }
+
+        // The freed slot is reused with a new generation, so the old handle stays dead
+        auto reused = names.emplace(3, 'x');
+        check_element(reused.slot, handles[3].slot);
+        check_element(reused == handles[3], false);
+        check_element(*names.find(reused), "xxx");
+        check_element(names.find(handles[3]) == nullptr, true);
+        check_element(names.handle_at(names.size() - 1) == reused, true);
+
+        // Erasing the last object needs no move
+        check_element(names.erase(reused), true);
+        check_element(names.size(), 9u);
+
+        size_t total = 0;
+        for (auto& name : names)
+        {
+            total += name.size();
+        }
+        check_element(total, 54u);
+
+        names.clear();
+        check_element(names.empty(), true);
+        check_element(names.contains(handles[0]), false);
+        auto fresh = names.insert("fresh");
+        check_element(*names.find(fresh), "fresh");
+        check_element(names.find(handles[9]) == nullptr, true);
+
+        // Move-only objects without a default constructor can be stored and cleared
+        slot_map<std::unique_ptr<no_default>> owned;
+        auto owned_handle = owned.emplace(std::make_unique<no_default>(8));
+        owned.emplace(nullptr);
+        check_element((*owned.find(owned_handle))->i, 8);
+        owned.clear();
+        check_element(owned.empty(), true);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
+
+std::string test_sparse_set()
+{
+    const std::string& func = __FUNCTION__;
+    try
+    {
+        auto check_element = [&func](const auto& actual, const auto& expected)
+        {
+            require_equal(func, "sparse set value", actual, expected);
+        };
+
+        sparse_set<int> positions;
+        sparse_set<std::string> names;
+        for (uint32_t id = 0; id < 20; ++id)
+        {
+            check_element(positions.insert(id, int(id) * 10), true);
+        }
+        check_element(positions.insert(5, 0), false);
+        check_element(*positions.find(5), 50);
+
+        // Ids far apart only allocate the pages they use
+        for (uint32_t id : { 3u, 7u, 1000000u, 15u })
+        {
+            names.emplace(id, "name " + std::to_string(id));
+        }
+        check_element(names.size(), 4u);
+        check_element(names.contains(1000000), true);
+        check_element(names.contains(999999), false);
+        check_element(names.contains(4000000000u), false);
+        check_element(*names.find(1000000), "name 1000000");
+        names.emplace(7, "seven");
+        check_element(*names.find(7), "seven");
+
+        // Erasing moves the last value into the gap
+        check_element(positions.erase(2), true);
+        check_element(positions.erase(2), false);
+        check_element(positions.contains(2), false);
+        check_element(positions.size(), 19u);
+        check_element(positions.ids()[2], 19u);
+        check_element(*positions.find(19), 190);
+
+        // Intersection walks the smaller set and finds each id in the other
+        std::string visited;
+        int sum = 0;
+        for_each_intersection([&](uint32_t id, const std::string&, int& position)
+        {
+            visited += std::to_string(id) + ",";
+            sum += position;
+            position = -1;
+        }, names, positions);
+        check_element(visited, "3,7,15,");
+        check_element(sum, 250);
+        check_element(*positions.find(15), -1);
+
+        // After sorting, shared ids come first in the same order as in the other set
+        positions.sort_as(names);
+        check_element(positions.ids()[0], 3u);
+        check_element(positions.ids()[1], 7u);
+        check_element(positions.ids()[2], 15u);
+        check_element(*positions.begin(), -1);
+        for (uint32_t id = 0; id < 20; ++id)
+        {
+            if (id != 2)
+            {
+                check_element(positions.ids()[positions.find(id) - &*positions.begin()], id);
+            }
+        }
+
+        names.clear();
+        check_element(names.empty(), true);
+        check_element(names.contains(1000000), false);
+        names.insert(1000000, "back");
+        check_element(*names.find(1000000), "back");
+
+        sparse_set<no_default> plain;
+        plain.emplace(9, 3);
+        plain.clear();
+        check_element(plain.contains(9), false);
+
+        sparse_set<std::unique_ptr<int>> owned;
+        owned.emplace(1, std::make_unique<int>(1));
+        owned.emplace(2, std::make_unique<int>(2));
+        owned.erase(1);
+        check_element(**owned.find(2), 2);
+        owned.clear();
+        check_element(owned.empty(), true);
+    }
+    catch (test_failed_exception e)
+    {
+        return e.what();
+    }
+
+    return func + " passed";
+}
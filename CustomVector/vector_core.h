@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "memory_policy.h"
+
+#if defined(_MSC_VER)
+#define CUSTOM_VECTOR_NOINLINE __declspec(noinline)
+#else
+#define CUSTOM_VECTOR_NOINLINE __attribute__((noinline))
+#endif
+
+/** Parts of custom_vector which don't depend on the element type. Being plain functions rather than templates,
+    every instantiation of custom_vector shares a single copy of them, which keeps slow paths out of each
+    instantiation's code and out of the instruction cache. */
+namespace vector_core
+{
+    /** Allocates uninitialized memory for count objects of the given size and alignment
+        @param[in] count Amount of objects
+        @param[in] size Size of one object
+        @param[in] align Alignment of the objects
+        @return The memory, or nullptr if it couldn't be allocated */
+    inline void* allocate(size_t count, size_t size, size_t align) noexcept
+    {
+        if (count > std::numeric_limits<size_t>::max() / size)
+        {
+            return nullptr;
+        }
+
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            return ::operator new(count * size, std::align_val_t(align), std::nothrow);
+        }
+        return ::operator new(count * size, std::nothrow);
+    }
+
+    /** Frees memory obtained from allocate()
+        @param[in] p The memory, may be nullptr
+        @param[in] align Alignment the memory was allocated with */
+    inline void deallocate(void* p, size_t align) noexcept
+    {
+        if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            ::operator delete(p, std::align_val_t(align));
+        }
+        else
+        {
+            ::operator delete(p);
+        }
+    }
+
+    /** Growth for trivially copyable objects: allocates a new buffer, applies the memory options and copies the
+        objects over as raw bytes. The old buffer is left for the caller to free, as it may not have been allocated here.
+        Nothing here can throw, so the new buffer can't leak between being allocated and being returned.
+        @param[in] old_data First object of the old buffer, may be nullptr if count is 0
+        @param[in] count Amount of objects to copy
+        @param[in] new_cap Capacity of the new buffer
+        @param[in] size Size of one object
+        @param[in] align Alignment of the objects
+        @param[in] options Memory options to apply to the new buffer
+        @param[out] locked Whether the new buffer was locked into RAM
+        @return The new buffer, or nullptr if it couldn't be allocated */
+    CUSTOM_VECTOR_NOINLINE inline void* reallocate_trivial(const void* old_data, size_t count, size_t new_cap,
+        size_t size, size_t align, const memory_options& options, bool& locked) noexcept
+    {
+        auto p = allocate(new_cap, size, align);
+        if (!p)
+        {
+            return nullptr;
+        }
+
+        locked = memory_policy::apply(p, new_cap * size, options);
+        if (count > 0)
+        {
+            std::memcpy(p, old_data, count * size);
+        }
+        return p;
+    }
+}